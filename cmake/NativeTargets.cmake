@@ -47,6 +47,13 @@ add_custom_target(tests-radio
   DEPENDS gtests-radio
   )
 
+if(CMAKE_SYSTEM_NAME STREQUAL "Linux")
+  add_custom_target(bench
+    COMMAND ${CMAKE_CURRENT_BINARY_DIR}/bench-radio -o ${CMAKE_CURRENT_BINARY_DIR}/bench-radio.json
+    DEPENDS bench-radio
+    )
+endif()
+
 if(Qt5Core_FOUND AND NOT DISABLE_COMPANION)
   add_subdirectory(${COMPANION_SRC_DIRECTORY})
   add_custom_target(tests-companion
@@ -23,6 +23,7 @@
 #include "appdata.h"
 #include "ui_logsdialog.h"
 #include "helpers.h"
+#include "radio/src/logs_binary.h"
 #if defined _MSC_VER || !defined __GNUC__
 #include <windows.h>
 #else
@@ -651,31 +652,177 @@ void LogsDialog::saveSession()
   }
 }
 
+static QString formatLogValue(int32_t value, uint8_t prec)
+{
+  if (prec == 0)
+    return QString::number(value);
+  int32_t div = (prec == 1 ? 10 : 100);
+  return QString("%1%2.%3").arg(value < 0 ? "-" : "").arg(abs(value / div)).arg(abs(value % div), prec, 10, QChar('0'));
+}
+
+static QString formatLogGps(int32_t value)
+{
+  return QString("%1%2.%3").arg(value < 0 ? "-" : "").arg(abs(value / 1000000)).arg(abs(value % 1000000), 6, 10, QChar('0'));
+}
+
+// Converts a binary log (see radio/src/logs_binary.h) to the lines of
+// the CSV log the radio would have written. Returns false if the data
+// is not a binary log, a truncated last row is ignored.
+static bool convertBinaryLog(const QByteArray & data, QStringList & lines)
+{
+  struct Field {
+    uint8_t kind;
+    uint8_t prec;
+  };
+
+  const uint8_t * p = (const uint8_t *)data.constData();
+  const uint8_t * end = p + data.size();
+
+  if (data.size() < 1 + LOG_BINARY_MAGIC_LEN || p[0] != LOG_BINARY_TAG_HEADER ||
+      memcmp(p + 1, LOG_BINARY_MAGIC, LOG_BINARY_MAGIC_LEN))
+    return false;
+
+  QVector<Field> fields;
+  QVector<int32_t> values;
+  QVector<QString> texts;
+
+  while (p < end) {
+    uint8_t tag = *p++;
+    if (tag == LOG_BINARY_TAG_HEADER) {
+      if (end - p < LOG_BINARY_MAGIC_LEN + 1 || memcmp(p, LOG_BINARY_MAGIC, LOG_BINARY_MAGIC_LEN) ||
+          p[LOG_BINARY_MAGIC_LEN] != LOG_BINARY_VERSION)
+        break;
+      p += LOG_BINARY_MAGIC_LEN + 1;
+
+      QStringList labels;
+      fields.clear();
+      while (p < end && *p != LOG_FIELD_END) {
+        if (end - p < 3 || end - p < 3 + p[2])
+          return !lines.isEmpty();
+        fields.append({p[0], p[1]});
+        labels.append(QString::fromUtf8((const char *)p + 3, p[2]));
+        p += 3 + p[2];
+      }
+      p++;
+
+      int count = 0;
+      for (const Field & field: fields) {
+        count += logFieldValuesCount(field.kind);
+      }
+      values.fill(0, count);
+      texts.fill(QString(), count);
+
+      // the radio writes the CSV header only once per file
+      if (lines.isEmpty())
+        lines.append(labels.join(','));
+    }
+    else if (tag == LOG_BINARY_TAG_ROW) {
+      // decode the whole row first, a truncated one is dropped
+      QVector<int32_t> row = values;
+      QVector<QString> rowTexts = texts;
+      int index = 0;
+      for (const Field & field: fields) {
+        for (int i = 0; i < logFieldValuesCount(field.kind); i++, index++) {
+          uint32_t value;
+          uint8_t len = logBinaryGetVarint(p, end - p, value);
+          if (!len)
+            return !lines.isEmpty();
+          p += len;
+          if (field.kind == LOG_FIELD_TEXT) {
+            if (value > 0) {
+              if (uint32_t(end - p) < value - 1)
+                return !lines.isEmpty();
+              rowTexts[index] = QString::fromUtf8((const char *)p, value - 1);
+              p += value - 1;
+            }
+          }
+          else {
+            row[index] = int32_t(uint32_t(row[index]) + uint32_t(logBinaryUnzigzag(value)));
+          }
+        }
+      }
+      values = row;
+      texts = rowTexts;
+
+      QStringList columns;
+      index = 0;
+      for (const Field & field: fields) {
+        int32_t value = values[index];
+        switch (field.kind) {
+          case LOG_FIELD_RTC:
+          {
+            QDateTime time = QDateTime::fromTime_t(uint32_t(value), Qt::UTC);
+            columns.append(time.toString("yyyy-MM-dd"));
+            columns.append(time.toString("HH:mm:ss") + QString(".%1").arg(values[index + 1], 2, 10, QChar('0')) + "0");
+            break;
+          }
+          case LOG_FIELD_VALUE:
+            columns.append(formatLogValue(value, field.prec));
+            break;
+          case LOG_FIELD_GPS:
+            if (value && values[index + 1])
+              columns.append(formatLogGps(value) + " " + formatLogGps(values[index + 1]));
+            else
+              columns.append("");
+            break;
+          case LOG_FIELD_DATETIME:
+          {
+            int32_t time = values[index + 1];
+            columns.append(QString("%1-%2-%3 %4:%5:%6").arg(value / 10000, 4, 10, QChar('0'))
+                           .arg((value / 100) % 100, 2, 10, QChar('0')).arg(value % 100, 2, 10, QChar('0'))
+                           .arg(time / 10000, 2, 10, QChar('0')).arg((time / 100) % 100, 2, 10, QChar('0'))
+                           .arg(time % 100, 2, 10, QChar('0')));
+            break;
+          }
+          case LOG_FIELD_TEXT:
+            columns.append("\"" + texts[index] + "\"");
+            break;
+          case LOG_FIELD_HEX64:
+            columns.append("0x" + QString("%1%2").arg(uint32_t(value), 8, 16, QChar('0'))
+                           .arg(uint32_t(values[index + 1]), 8, 16, QChar('0')).toUpper());
+            break;
+          default:
+            columns.append(QString::number(value));
+            break;
+        }
+        index += logFieldValuesCount(field.kind);
+      }
+      lines.append(columns.join(','));
+    }
+    else {
+      break;
+    }
+  }
+
+  return true;
+}
+
 bool LogsDialog::cvsFileParse()
 {
   QFile file(ui->FileName_LE->text());
   int errors=0;
   int lines=-1;
 
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) { // reading HEX TEXT file
+  if (!file.open(QIODevice::ReadOnly)) {
     return false;
   }
   else {
     csvlog.clear();
     logFilename.clear();
-    QTextStream inputStream(&file);
-    QString buffer = file.readLine();
 
-    if (buffer.startsWith("Date,Time")) {
-      file.reset();
+    QStringList input;
+    QByteArray data = file.readAll();
+    if (!convertBinaryLog(data, input)) {
+      input = QString::fromUtf8(data).split('\n', QString::SkipEmptyParts);
     }
-    else {
+
+    if (input.isEmpty() || !input.first().startsWith("Date,Time")) {
       return false;
     }
 
     int numfields=-1;
-    while (!file.atEnd()) {
-      QString line = file.readLine().trimmed();
+    for (const QString & buffer: input) {
+      QString line = buffer.trimmed();
       QStringList columns = line.split(',');
       if (numfields==-1) {
         numfields=columns.count();
@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define SWAP_DEFINED
+#include "opentx.h"
+#include "stamp.h"
+#include "storage/sdcard_yaml.h"
+#include "telemetry/frsky.h"
+
+/*
+ * Host-side throughput benchmark for the mixer and its neighbours.
+ *
+ * Each model from BENCH_SDCARD_PATH/MODELS (a copy of bench/sdcard made
+ * in the build directory) is loaded and the hot paths of the mixer task
+ * are timed call by call with the sticks sweeping and the flight mode
+ * switch moving. Results are printed as JSON so that they can be compared
+ * between builds.
+ */
+
+#define BENCH_DEFAULT_ITERATIONS  20000
+#define BENCH_LOAD_DIVIDER        100  // YAML loads are way slower than a mixer cycle
+#define BENCH_MIXER_PERIOD_MS     4
+
+// Symbols the simu sources expect from the main program (see tests/gtests.cpp)
+int32_t lastAct = 0;
+uint16_t anaInValues[NUM_STICKS+NUM_POTS+NUM_SLIDERS] = { 0 };
+uint16_t anaIn(uint8_t chan)
+{
+  if (chan < NUM_STICKS+NUM_POTS+NUM_SLIDERS)
+    return anaInValues[chan];
+  else
+    return 0;
+}
+
+uint16_t getAnalogValue(uint8_t index)
+{
+  return anaIn(index);
+}
+
+struct BenchModel {
+  const char * name;
+  const char * filename;
+  bool luaScripts;
+};
+
+static const BenchModel benchModels[] = {
+  { "plane", "plane.yml", false },
+  { "glider", "glider.yml", false },
+  { "heli", "heli.yml", false },
+  { "lua", "lua.yml", true },
+};
+
+struct BenchSensor {
+  uint16_t id;
+  uint8_t instance;
+  uint32_t min;
+  uint32_t max;
+};
+
+// One S.PORT frame worth of sensors, the bench models are built against them
+static const BenchSensor benchSensors[] = {
+  { RSSI_ID, 0x18, 40, 100 },
+  { BATT_ID, 0x18, 40, 60 },
+  { VFAS_FIRST_ID, 0x02, 1100, 1260 },
+  { CURR_FIRST_ID, 0x02, 0, 400 },
+  { ALT_FIRST_ID, 0x00, 0, 15000 },
+  { VARIO_FIRST_ID, 0x00, 0, 500 },
+  { RPM_FIRST_ID, 0x04, 0, 2500 },
+};
+
+struct BenchResult {
+  const char * name;
+  uint32_t iterations;
+  uint32_t min;
+  uint32_t max;
+  uint32_t mean;
+  uint32_t p50;
+  uint32_t p99;
+};
+
+static std::vector<BenchResult> benchResults;
+
+template <typename Prepare, typename Run>
+static void benchRun(const char * name, uint32_t iterations, Prepare prepare, Run run)
+{
+  typedef std::chrono::steady_clock clock;
+  std::vector<uint32_t> samples(iterations);
+  uint64_t sum = 0;
+
+  // warm up caches and the mixer state before sampling
+  for (uint32_t i = 0; i < iterations / 10; i++) {
+    prepare(i);
+    run(i);
+  }
+
+  for (uint32_t i = 0; i < iterations; i++) {
+    prepare(i);
+    auto start = clock::now();
+    run(i);
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+    samples[i] = duration.count();
+    sum += samples[i];
+  }
+
+  std::sort(samples.begin(), samples.end());
+  BenchResult result;
+  result.name = name;
+  result.iterations = iterations;
+  result.min = samples.front();
+  result.max = samples.back();
+  result.mean = sum / iterations;
+  result.p50 = samples[iterations / 2];
+  result.p99 = samples[(uint64_t)iterations * 99 / 100];
+  benchResults.push_back(result);
+}
+
+static void benchNothing(uint32_t)
+{
+}
+
+static void benchSetInputs(uint32_t iteration)
+{
+  // triangle sweep on every stick and pot, each one with its own phase
+  for (int i = 0; i < NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    int32_t pos = (iteration * 8 + i * 512) % 4096;
+    anaInValues[i] = (pos < 2048 ? pos : 4096 - pos) - 1024;
+  }
+
+  // SA drives the flight modes of the bench models
+  if (iteration % 1000 == 0) {
+    simuSetSwitch(0, (iteration / 1000) % 3 - 1);
+  }
+
+  getSwitchesPosition(false);
+}
+
+static uint8_t benchTick(uint32_t iteration)
+{
+  uint32_t now = iteration * BENCH_MIXER_PERIOD_MS / 10;
+  uint32_t next = (iteration + 1) * BENCH_MIXER_PERIOD_MS / 10;
+  if (now == next) {
+    return 0;
+  }
+  g_tmr10ms++;
+  return 1;
+}
+
+static void benchSetSensors(uint32_t iteration)
+{
+  for (const auto & sensor: benchSensors) {
+    uint32_t span = sensor.max - sensor.min + 1;
+    uint32_t value = sensor.min + (iteration * 7 + sensor.id) % span;
+    sportProcessTelemetryPacket(sensor.id, 0, sensor.instance, value);
+  }
+}
+
+static const char * benchModel(const BenchModel & model, uint32_t iterations)
+{
+  const char * error = nullptr;
+
+  // the YAML parser is timed, the model cache is not used
+  benchRun("yamlLoad", std::max<uint32_t>(iterations / BENCH_LOAD_DIVIDER, 10), benchNothing,
+           [&](uint32_t) {
+             const char * result = readModelYaml(model.filename, (uint8_t *)&g_model, sizeof(g_model),
+                                                 STR_MODELS_PATH, ModelCache::None);
+             if (result) error = result;
+           });
+  if (error) {
+    return error;
+  }
+
+  postModelLoad(false);
+
+#if defined(LUA_MODEL_SCRIPTS)
+  if (model.luaScripts) {
+    luaState = INTERPRETER_RELOAD_PERMANENT_SCRIPTS;
+    for (int i = 0; i < 100 && luaState != INTERPRETER_RUNNING; i++) {
+      luaTask(0, false);
+    }
+    if (luaState != INTERPRETER_RUNNING) {
+      return "Lua scripts not running";
+    }
+  }
+#endif
+
+  uint8_t tick10ms = 0;
+  auto prepareMixer = [&](uint32_t i) {
+    benchSetInputs(i);
+    tick10ms = benchTick(i);
+  };
+
+  benchRun("evalMixes", iterations, prepareMixer,
+           [&](uint32_t) { evalMixes(tick10ms); });
+
+  // sticks left alone (all the inputs keep their value)
+  benchRun("evalMixesIdle", iterations,
+           [&](uint32_t i) {
+             benchSetInputs(0);
+             tick10ms = benchTick(i);
+           },
+           [&](uint32_t) { evalMixes(tick10ms); });
+
+  benchRun("evalLogicalSwitches", iterations, prepareMixer,
+           [](uint32_t) { evalLogicalSwitches(); });
+
+#if defined(LUA_MODEL_SCRIPTS)
+  if (model.luaScripts) {
+    benchRun("luaTask", iterations, prepareMixer,
+             [](uint32_t) { luaTask(0, false); });
+  }
+#endif
+
+  benchRun("telemetryFrame", iterations, benchNothing, benchSetSensors);
+
+  benchRun("telemetryWakeup", iterations, benchSetSensors,
+           [](uint32_t) { telemetryWakeup(); });
+
+  return nullptr;
+}
+
+static void benchPrintResults(FILE * out)
+{
+  for (size_t i = 0; i < benchResults.size(); i++) {
+    const BenchResult & result = benchResults[i];
+    fprintf(out,
+            "        \"%s\": { \"iterations\": %u, \"mean_ns\": %u, \"min_ns\": %u, "
+            "\"p50_ns\": %u, \"p99_ns\": %u, \"max_ns\": %u }%s\n",
+            result.name, result.iterations, result.mean, result.min,
+            result.p50, result.p99, result.max,
+            i + 1 < benchResults.size() ? "," : "");
+  }
+}
+
+static void usage(const char * name)
+{
+  fprintf(stderr,
+          "Usage: %s [-n iterations] [-o output.json] [-d sdcard] [model...]\n"
+          "Models: ", name);
+  for (const auto & model: benchModels) {
+    fprintf(stderr, "%s ", model.name);
+  }
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char ** argv)
+{
+  uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+  const char * output = nullptr;
+  const char * sdPath = BENCH_SDCARD_PATH;
+  std::vector<const char *> selection;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      iterations = strtoul(argv[++i], nullptr, 10);
+    }
+    else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      output = argv[++i];
+    }
+    else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+      sdPath = argv[++i];
+    }
+    else if (argv[i][0] == '-') {
+      usage(argv[0]);
+      return 1;
+    }
+    else {
+      selection.push_back(argv[i]);
+    }
+  }
+
+  if (iterations < 100) {
+    fprintf(stderr, "At least 100 iterations are needed\n");
+    return 1;
+  }
+
+  // keep stdout for the results, traces go to stderr
+  FILE * out = output ? fopen(output, "w") : fdopen(dup(STDOUT_FILENO), "w");
+  if (!out) {
+    fprintf(stderr, "Cannot open %s\n", output ? output : "stdout");
+    return 1;
+  }
+  dup2(STDERR_FILENO, STDOUT_FILENO);
+
+  simuInit();
+  simuFatfsSetPaths(sdPath, sdPath);
+  generalDefault();
+  g_eeGeneral.templateSetup = 0;
+  for (int i = 0; i < NUM_SWITCHES; i++) {
+    simuSetSwitch(i, -1);
+  }
+#if !defined(COLORLCD)
+  menuLevel = 0;
+#endif
+
+  fprintf(out, "{\n");
+  fprintf(out, "  \"flavour\": \"%s\",\n", FLAVOUR);
+  fprintf(out, "  \"version\": \"%s\",\n", VERSION);
+  fprintf(out, "  \"iterations\": %u,\n", iterations);
+  fprintf(out, "  \"models\": [");
+
+  int result = 0;
+  bool first = true;
+  for (const auto & model: benchModels) {
+    if (!selection.empty() &&
+        std::none_of(selection.begin(), selection.end(),
+                     [&](const char * name) { return !strcmp(name, model.name); })) {
+      continue;
+    }
+
+    fprintf(out, "%s\n    {\n", first ? "" : ",");
+    fprintf(out, "      \"name\": \"%s\",\n", model.name);
+    fprintf(out, "      \"file\": \"%s\",\n", model.filename);
+    first = false;
+
+#if !defined(LUA_MODEL_SCRIPTS)
+    if (model.luaScripts) {
+      fprintf(out, "      \"skipped\": \"LUA_MIXER disabled\"\n    }");
+      continue;
+    }
+#endif
+
+    benchResults.clear();
+    const char * error = benchModel(model, iterations);
+    if (error) {
+      fprintf(stderr, "%s: %s\n", model.filename, error);
+      fprintf(out, "      \"error\": \"%s\"\n    }", error);
+      result = 1;
+      continue;
+    }
+
+    fprintf(out, "      \"results\": {\n");
+    benchPrintResults(out);
+    fprintf(out, "      }\n    }");
+  }
+
+  fprintf(out, "\n  ]\n}\n");
+
+  fclose(out);
+
+  return result;
+}
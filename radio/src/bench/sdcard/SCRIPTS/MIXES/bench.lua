@@ -0,0 +1,18 @@
+-- Elevon mixer with adjustable differential, used by the bench-radio lua model
+
+local inputs = {
+  { "Ail", SOURCE },
+  { "Ele", SOURCE },
+  { "Diff", VALUE, 0, 100, 50 },
+}
+
+local outputs = { "ElvL", "ElvR" }
+
+local function run(ail, ele, diff)
+  local up = ail * (100 - diff) / 100
+  local left = ele + (ail > 0 and ail or up)
+  local right = ele - (ail < 0 and ail or up)
+  return math.max(-1024, math.min(1024, left)), math.max(-1024, math.min(1024, right))
+end
+
+return { input = inputs, output = outputs, run = run }
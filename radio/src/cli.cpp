@@ -29,6 +29,9 @@
 
 #include "tasks.h"
 #include "tasks/mixer_task.h"
+#include "mixer_stats.h"
+#include "latency.h"
+#include "mixer_scheduler.h"
 
 #include "cli.h"
 
@@ -847,6 +850,7 @@ int cliStackInfo(const char ** argv)
   cliSerialPrint("[MENUS] %d available / %d bytes", menusStack.available()*4, menusStack.size());
   cliSerialPrint("[MIXER] %d available / %d bytes", mixerStack.available()*4, mixerStack.size());
   cliSerialPrint("[AUDIO] %d available / %d bytes", audioStack.available()*4, audioStack.size());
+  cliSerialPrint("[LOGS] %d available / %d bytes", logsStack.available()*4, logsStack.size());
   cliSerialPrint("[CLI] %d available / %d bytes", cliStack.available()*4, cliStack.size());
   return 0;
 }
@@ -1444,6 +1448,137 @@ int cliShowJitter(const char ** argv)
 }
 #endif
 
+int cliMixerStats(const char ** argv)
+{
+  const char * arg = argv[1] ? argv[1] : "";
+
+  if (!strcmp(arg, "reset")) {
+    mixerStatsReset();
+    return 0;
+  }
+
+  bool hist = !strcmp(arg, "hist");
+  if (!hist && arg[0]) {
+    cliSerialPrint("%s: Invalid argument \"%s\"", argv[0], arg);
+    return -1;
+  }
+
+  cliSerialPrint("stage      count   avg   p50   p99   max (us)");
+  for (uint8_t stage = 0; stage < MIXER_STAGE_COUNT; stage++) {
+    const MixerStageStats & stats = mixerStatsGet(stage);
+    cliSerialPrint("%-9s %6u %5u %5u %5u %5u", mixerStageNames[stage],
+                   (unsigned)stats.count, mixerStatsAverage(stage),
+                   mixerStatsPercentile(stage, 50),
+                   mixerStatsPercentile(stage, 99), stats.max);
+  }
+
+  if (hist) {
+    for (uint8_t stage = 0; stage < MIXER_STAGE_COUNT; stage++) {
+      const MixerStageStats & stats = mixerStatsGet(stage);
+      cliSerialPrintf("%-9s", mixerStageNames[stage]);
+      for (uint8_t bucket = 0; bucket < MIXER_STATS_BUCKETS; bucket++) {
+        if (stats.buckets[bucket])
+          cliSerialPrintf(" <%u:%u", 2u << bucket, (unsigned)stats.buckets[bucket]);
+      }
+      cliSerialCrlf();
+    }
+  }
+  return 0;
+}
+
+int cliLogsStats(const char ** argv)
+{
+  const char * arg = argv[1] ? argv[1] : "";
+
+  if (!strcmp(arg, "reset")) {
+    logsResetStats();
+    return 0;
+  }
+  else if (arg[0]) {
+    cliSerialPrint("%s: Invalid argument \"%s\"", argv[0], arg);
+    return -1;
+  }
+
+  const LogsStats & stats = logsGetStats();
+  cliSerialPrint("rows: %u, dropped: %u", (unsigned)stats.rows, (unsigned)stats.droppedRows);
+  cliSerialPrint("queue max: %u bytes", (unsigned)stats.maxQueueDepth);
+  cliSerialPrint("write max: %u ms", (unsigned)stats.maxWriteDuration);
+  return 0;
+}
+
+int cliLatency(const char ** argv)
+{
+  const char * arg = argv[1] ? argv[1] : "";
+
+  if (!strcmp(arg, "on")) {
+    latencyMeasureStart();
+    return 0;
+  }
+  else if (!strcmp(arg, "off")) {
+    latencyMeasureStop();
+    return 0;
+  }
+  else if (!strcmp(arg, "reset")) {
+    latencyMeasureReset();
+    return 0;
+  }
+  else if (arg[0]) {
+    cliSerialPrint("%s: Invalid arguments", argv[0]);
+    return -1;
+  }
+
+  cliSerialPrint("latency measurement %s", latencyMeasureActive() ? "on" : "off");
+  cliSerialPrint("module point   count   min   avg   p99   max (us)");
+  for (uint8_t module = 0; module < NUM_MODULES; module++) {
+    const ModuleLatencyStats & stats = latencyGetStats(module);
+    cliSerialPrint("%-6u %-6s %6u %5u %5u %5u %5u", (unsigned)module,
+                   stats.txComplete ? "tx" : "queued", (unsigned)stats.count,
+                   stats.min, latencyAverage(module),
+                   latencyPercentile(module, 99), stats.max);
+  }
+  return 0;
+}
+
+int cliMixerSync(const char ** argv)
+{
+  const char * arg = argv[1] ? argv[1] : "";
+
+  if (!strcmp(arg, "margin")) {
+    int margin = 0;
+    if (toInt(argv, 2, &margin) <= 0 || margin < 0) {
+      cliSerialPrint("%s: Invalid arguments", argv[0]);
+      return -1;
+    }
+    mixerSchedulerSetSyncMargin(margin);
+    return 0;
+  }
+  else if (!strcmp(arg, "reset")) {
+    for (uint8_t module = 0; module < NUM_MODULES; module++) {
+      getModuleSyncStatus(module).resetStats();
+    }
+    return 0;
+  }
+  else if (arg[0]) {
+    cliSerialPrint("%s: Invalid arguments", argv[0]);
+    return -1;
+  }
+
+  cliSerialPrint("margin %uus", mixerSchedulerGetSyncMargin());
+  cliSerialPrint("module  rate   lag trim(ns)  count   avg   min   max (us)");
+  for (uint8_t module = 0; module < NUM_MODULES; module++) {
+    const ModuleSyncStatus & status = getModuleSyncStatus(module);
+    if (!status.isValid())
+      continue;
+    cliSerialPrint("%-6u %5u %5d %8d %6u %5u %5d %5d", (unsigned)module,
+                   status.refreshRate, status.inputLag,
+                   (int)(status.periodTrim * 1000 / 256),
+                   (unsigned)status.phaseErrorCount,
+                   status.getPhaseErrorAverage(), status.phaseErrorMin,
+                   status.phaseErrorMax);
+  }
+  return 0;
+}
+
 #if defined(INTERNAL_GPS)
 int cliGps(const char ** argv)
 {
@@ -1620,6 +1755,10 @@ const CliCommand cliCommands[] = {
   { "repeat", cliRepeat, "<interval> <command>" },
 #endif
   { "help", cliHelp, "[<command>]" },
+  { "mixerstats", cliMixerStats, "[hist | reset]" },
+  { "latency", cliLatency, "[on | off | reset]" },
+  { "mixersync", cliMixerSync, "[reset | margin <us>]" },
+  { "logstats", cliLogsStats, "[reset]" },
 #if defined(JITTER_MEASURE)
   { "jitter", cliShowJitter, "" },
 #endif
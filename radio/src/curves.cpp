@@ -31,6 +31,18 @@ constexpr int CUSTOM_CURVE_POINTS(int p) { return 2 * p + (2 * DEFAULT_POINTS -
 
 int8_t * curveEnd[MAX_CURVES];
 
+struct CurveLut {
+  int16_t values[CURVE_LUT_SIZE];
+};
+
+static CurveLut curveLuts[MAX_CURVE_LUTS];
+static uint8_t curveLutIndex[MAX_CURVES];  // slot + 1, 0 if none
+
+// The tables are only used while they have been built for the latest
+// model change, the spline is computed instead during a rebuild
+static volatile uint8_t curveLutsSerial = 1;  // bumped on each model change
+static volatile uint8_t curveLutsBuilt = 0;   // serial the tables match
+
 uint8_t getCurvePoints(uint8_t index)
 {
   if (index >= MAX_CURVES)
@@ -77,6 +89,9 @@ void loadCurves()
   if (showWarning) {
     POPUP_WARNING("Invalid curve data repaired", "check your curves, logic switches");
   }
+
+  curvesLutInvalidate();
+  curvesLutUpdate();
 }
 
 int8_t * curveAddress(uint8_t idx)
@@ -233,6 +248,24 @@ int32_t compute_tangent(CurveHeader* crv, const int8_t* points, int i)
    http://en.wikipedia.org/wiki/Cubic_Hermite_spline
    The tangents are computed via the 'cubic monotone' rules (allowing for local-maxima)
 */
+static int16_t hermite_segment(int32_t x, int32_t p0x, int32_t p3x,
+                               int32_t p0y, int32_t p3y, int32_t m0,
+                               int32_t m3)
+{
+  int32_t y;
+  int32_t h = p3x - p0x;
+  int32_t t = (h > 0 ? (MMULT * (x - p0x)) / h : 0);
+  int32_t t2 = t * t / MMULT;
+  int32_t t3 = t2 * t / MMULT;
+  int32_t h00 = 2*t3 - 3*t2 + MMULT;
+  int32_t h10 = t3 - 2*t2 + t;
+  int32_t h01 = -2*t3 + 3*t2;
+  int32_t h11 = t3 - t2;
+  y = p0y * h00 + h * (m0 * h10 / MMULT) + p3y * h01 + h * (m3 * h11 / MMULT);
+  y /= MMULT;
+  return y;
+}
+
 int16_t hermite_spline(int16_t x, uint8_t idx)
 {
   CurveHeader &crv = g_model.curves[idx];
@@ -257,27 +290,95 @@ int16_t hermite_spline(int16_t x, uint8_t idx)
     }
 
     if (x >= p0x && x <= p3x) {
-      int32_t p0y = calc100toRESX(points[i]);
-      int32_t p3y = calc100toRESX(points[i+1]);
       int32_t m0 = compute_tangent(&crv, points, i);
       int32_t m3 = compute_tangent(&crv, points, i+1);
-      int32_t y;
-      int32_t h = p3x - p0x;
-      int32_t t = (h > 0 ? (MMULT * (x - p0x)) / h : 0);
-      int32_t t2 = t * t / MMULT;
-      int32_t t3 = t2 * t / MMULT;
-      int32_t h00 = 2*t3 - 3*t2 + MMULT;
-      int32_t h10 = t3 - 2*t2 + t;
-      int32_t h01 = -2*t3 + 3*t2;
-      int32_t h11 = t3 - t2;
-      y = p0y * h00 + h * (m0 * h10 / MMULT) + p3y * h01 + h * (m3 * h11 / MMULT);
-      y /= MMULT;
-      return y;
+      return hermite_segment(x, p0x, p3x, calc100toRESX(points[i]),
+                             calc100toRESX(points[i+1]), m0, m3);
     }
   }
   return 0;
 }
 
+// Same samples as hermite_spline() would give, but the segment
+// and its tangents are only computed once
+static void curveLutBuild(CurveLut & lut, uint8_t idx)
+{
+  CurveHeader &crv = g_model.curves[idx];
+  int8_t *points = curveAddress(idx);
+  uint8_t count = STD_CURVE_POINTS(crv.points);
+  bool custom = (crv.type == CURVE_TYPE_CUSTOM);
+
+  int i = -1;
+  int32_t p0x = 0, p3x = -RESX - 1, m0 = 0, m3 = 0;
+
+  for (int n = 0; n < CURVE_LUT_SIZE; n++) {
+    int32_t x = -RESX + (n << CURVE_LUT_SHIFT);
+
+    while (x > p3x && i < count - 2) {
+      i++;
+      if (custom) {
+        p0x = (i>0 ? calc100toRESX(points[count+i-1]) : -RESX);
+        p3x = (i<count-2 ? calc100toRESX(points[count+i]) : RESX);
+      }
+      else {
+        p0x = -RESX + (i*2*RESX)/(count-1);
+        p3x = -RESX + ((i+1)*2*RESX)/(count-1);
+      }
+      m0 = compute_tangent(&crv, points, i);
+      m3 = compute_tangent(&crv, points, i+1);
+    }
+
+    if (x >= p0x && x <= p3x) {
+      lut.values[n] = hermite_segment(x, p0x, p3x, calc100toRESX(points[i]),
+                                      calc100toRESX(points[i+1]), m0, m3);
+    } else {
+      lut.values[n] = hermite_spline(x, idx);
+    }
+  }
+}
+
+void curvesLutInvalidate()
+{
+  curveLutsSerial++;
+}
+
+void curvesLutUpdate()
+{
+  uint8_t serial = curveLutsSerial;
+  if (curveLutsBuilt == serial)
+    return;
+
+  curveLutsBuilt = serial - 1;
+
+  uint8_t slot = 0;
+  for (uint8_t idx = 0; idx < MAX_CURVES; idx++) {
+    if (!g_model.curves[idx].smooth || slot >= MAX_CURVE_LUTS) {
+      curveLutIndex[idx] = 0;
+      continue;
+    }
+    curveLutBuild(curveLuts[slot], idx);
+    curveLutIndex[idx] = ++slot;
+  }
+
+  // still stale if the model was changed in the meantime
+  curveLutsBuilt = serial;
+}
+
+static int curveLutApply(const CurveLut & lut, int x)
+{
+  if (x <= -RESX)
+    return lut.values[0];
+  else if (x >= RESX)
+    return lut.values[CURVE_LUT_SIZE - 1];
+
+  x += RESX;
+  int n = x >> CURVE_LUT_SHIFT;
+  int frac = x & ((1 << CURVE_LUT_SHIFT) - 1);
+  int y0 = lut.values[n];
+  int y1 = lut.values[n + 1];
+  return y0 + divRoundClosest((y1 - y0) * frac, 1 << CURVE_LUT_SHIFT);
+}
+
 int intpol(int x, uint8_t idx) // -100, -75, -50, -25, 0 ,25 ,50, 75, 100
 {
   CurveHeader& crv = g_model.curves[idx];
@@ -377,8 +478,12 @@ int applyCustomCurve(int x, uint8_t idx)
     return 0;
 
   CurveHeader & crv = g_model.curves[idx];
-  if (crv.smooth)
+  if (crv.smooth) {
+    uint8_t slot = curveLutIndex[idx];
+    if (slot && curveLutsBuilt == curveLutsSerial)
+      return curveLutApply(curveLuts[slot - 1], x);
     return hermite_spline(x, idx);
+  }
   else
     return intpol(x, idx);
 }
@@ -47,6 +47,22 @@ int applyCustomCurve(int x, uint8_t idx);
 int applyCurve(int x, CurveRef & curve);
 int applyCurrentCurve(int x);
 
+// Smooth curves are sampled into lookup tables (every 8 steps between
+// -RESX and RESX) which are then linearly interpolated. The tables are
+// built by loadCurves(), then rebuilt by the main loop after each model
+// change (curvesLutInvalidate() from mixerPlansInvalidate()). Each table
+// takes 514 bytes of RAM, smooth curves beyond MAX_CURVE_LUTS are computed.
+#if defined(COLORLCD)
+  #define MAX_CURVE_LUTS               16
+#else
+  #define MAX_CURVE_LUTS               2
+#endif
+#define CURVE_LUT_SHIFT                3
+#define CURVE_LUT_SIZE                 ((2 * RESX >> CURVE_LUT_SHIFT) + 1)
+
+void curvesLutInvalidate();
+void curvesLutUpdate();
+
 char *getCurveRefString(char *dest, size_t len, const CurveRef& curve);
 
 #endif
@@ -55,6 +55,11 @@ class Fifo
       ridx = nextIndex(ridx);
     }
 
+    void skip(uint32_t count)
+    {
+      ridx = (ridx + count) & (N - 1);
+    }
+
     bool pop(T & element)
     {
       if (isEmpty()) {
@@ -99,6 +104,16 @@ class Fifo
       }
     }
 
+    // Elements which can be read in place from the read index,
+    // up to the write index or the end of the buffer
+    uint32_t readSpan(const T ** data) const
+    {
+      uint32_t w = widx;
+      uint32_t r = ridx;
+      *data = &fifo[r];
+      return (w >= r ? w : N) - r;
+    }
+
     T * buffer()
     {
       return fifo;
@@ -336,7 +336,25 @@ void gpsSetSerialDriver(void* ctx, const etx_serial_driver_t* drv)
 void gpsWakeup()
 {
   if (!gpsSerialDrv) return;
-  
+
+  if (gpsSerialDrv->getRxSpan && gpsSerialDrv->skipRxBytes) {
+    // parse the received data in place
+    const uint8_t* data;
+    int count;
+    while ((count = gpsSerialDrv->getRxSpan(gpsSerialCtx, &data)) > 0) {
+      for (int i = 0; i < count; i++) {
+#if defined(DEBUG)
+        if (gpsTraceEnabled) {
+          dbgSerialPutc(data[i]);
+        }
+#endif
+        gpsNewData(data[i]);
+      }
+      gpsSerialDrv->skipRxBytes(gpsSerialCtx, count);
+    }
+    return;
+  }
+
   auto _getByte = gpsSerialDrv->getByte;
   if (!_getByte) return;
 
@@ -25,6 +25,7 @@
 #include "lvgl_widgets/input_mix_group.h"
 
 #include "opentx.h"
+#include "mixer_plan.h"
 
 #include <algorithm>
 
@@ -131,3 +132,19 @@ bool InputMixGroup::removeLine(Window* line)
 
   return false;
 }
+
+void InputMixGroup::checkEvents()
+{
+  Window::checkEvents();
+
+  // highlight channels which are part of a dependency loop
+  if (idx < MIXSRC_FIRST_CH || idx > MIXSRC_LAST_CH) return;
+  bool loop = mixerPlanChannelInLoop(idx - MIXSRC_CH1);
+  if (loop != inLoop) {
+    inLoop = loop;
+    if (loop)
+      lv_obj_set_style_text_color(label, makeLvColor(COLOR_THEME_WARNING), 0);
+    else
+      lv_obj_remove_local_style_prop(label, LV_STYLE_TEXT_COLOR, 0);
+  }
+}
@@ -261,6 +261,9 @@ class ModelButton : public Button
   {
     const char *error = nullptr;
 
+    // header read on demand, when the model is first displayed
+    modelslist.fetchModelCell(modelCell);
+
     delete buffer;
     buffer = new BitmapBuffer(BMP_RGB565, width(), height());
     if (buffer == nullptr) {
@@ -20,6 +20,7 @@
  */
 
 #include "opentx.h"
+#include "mixer_plan.h"
 #include "tasks/mixer_task.h"
 
 #define _STR_MAX(x)                     "/" #x
@@ -419,7 +420,7 @@ void menuModelMixAll(event_t event)
     coord_t y = MENU_HEADER_HEIGHT+1+(cur-menuVerticalOffset)*FH;
     if (i<MAX_MIXERS && (md=mixAddress(i))->srcRaw && md->destCh+1 == ch) {
       if (cur-menuVerticalOffset >= 0 && cur-menuVerticalOffset < NUM_BODY_LINES) {
-        putsChn(0, y, ch, 0); // show CHx
+        putsChn(0, y, ch, mixerPlanChannelInLoop(ch - 1) ? BLINK : 0); // show CHx
       }
       uint8_t mixCnt = 0;
       do {
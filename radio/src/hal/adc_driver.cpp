@@ -24,6 +24,7 @@
 
 // IS_POT_SLIDER_AVAILABLE()
 #include "opentx.h"
+#include "latency.h"
 
 const etx_hal_adc_driver_t* etx_hal_adc_driver = nullptr;
 
@@ -264,6 +265,7 @@ void getADC()
   if (!adcRead())
       TRACE("adcRead failed");
   DEBUG_TIMER_STOP(debugTimerAdcRead);
+  latencyAdcSampled();
 
   for (uint8_t x=0; x<NUM_ANALOGS; x++) {
     uint32_t v;
@@ -57,4 +57,9 @@ struct etx_proto_driver_t {
 
     // Process input data byte (telemetry)
     void (*processData)(void* context, uint8_t data, uint8_t* buffer, uint8_t* len);
+
+    // Process a block of input data (telemetry), optional: processData()
+    // is called for each byte when not provided
+    void (*processBuffer)(void* context, const uint8_t* data, uint32_t size,
+                          uint8_t* buffer, uint8_t* len);
 };
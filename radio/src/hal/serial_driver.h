@@ -55,6 +55,7 @@ struct etx_serial_callbacks_t {
   void (*on_receive)(uint8_t data);
   void (*on_idle)();
   void (*on_error)();
+  void (*on_tx_complete)();
 };
 
 enum SerialHWOption {
@@ -88,6 +89,13 @@ typedef struct {
   // Fetch next available byte from internal buffer
   int (*getByte)(void* ctx, uint8_t* data);
 
+  // Get the next contiguous block of received data, read in place
+  // from the internal buffer, returns its length
+  int (*getRxSpan)(void* ctx, const uint8_t** data);
+
+  // Release len bytes from the block returned by getRxSpan
+  void (*skipRxBytes)(void* ctx, uint32_t len);
+
   // Fetch a byte by its index from the end of the buffer
   int (*getLastByte)(void* ctx, uint32_t idx, uint8_t* data);
   
@@ -111,4 +119,7 @@ typedef struct {
   void (*setIdleCb)(void* ctx, void (*on_idle)());
   void (*setBaudrateCb)(void* ctx, void (*on_set_baudrate)(uint32_t));
 
+  // Called from IRQ once the last byte of a transmission has been sent
+  void (*setTxCompleteCb)(void* ctx, void (*on_tx_complete)());
+
 } etx_serial_driver_t;
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "opentx.h"
+#include "latency.h"
+#include "hal/module_port.h"
+
+static volatile bool latencyActive = false;
+
+static LatencyTimestamp adcSample;
+static LatencyTimestamp outputsSample;
+
+static LatencyTimestamp pendingFrame[NUM_MODULES];
+static volatile bool pendingFrameValid[NUM_MODULES];
+static bool txCompleteAttached[NUM_MODULES];
+
+static ModuleLatencyStats latencyStats[NUM_MODULES];
+
+static void latencyTimestamp(LatencyTimestamp & ts)
+{
+  ts.tmr2MHz = getTmr2MHz();
+  ts.tmr10ms = get_tmr10ms();
+}
+
+// The 2MHz timer wraps every 32.768ms: the 10ms tick, known within 10ms,
+// tells how many times it wrapped
+static uint32_t latencyElapsedUs(const LatencyTimestamp & start)
+{
+  uint32_t us = (uint16_t)(getTmr2MHz() - start.tmr2MHz) / 2;
+  uint32_t estimate = (get_tmr10ms() - start.tmr10ms) * 10000;
+  while (us + 16384 < estimate) {
+    us += 32768;
+  }
+  return us;
+}
+
+static void latencyRecord(uint8_t module, const LatencyTimestamp & start)
+{
+  // longer delays are saturated, they end in the last bucket
+  uint16_t us = min<uint32_t>(latencyElapsedUs(start), UINT16_MAX);
+
+  ModuleLatencyStats & stats = latencyStats[module];
+  if (!stats.count || us < stats.min)
+    stats.min = us;
+  if (us > stats.max)
+    stats.max = us;
+  stats.count++;
+  stats.sum += us;
+  stats.txComplete = txCompleteAttached[module];
+
+  uint8_t bucket = min<uint16_t>(us / LATENCY_BUCKET_US, LATENCY_BUCKETS - 1);
+  if (++stats.buckets[bucket] == UINT16_MAX) {
+    // keep the distribution, drop the resolution
+    for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+      stats.buckets[i] /= 2;
+    }
+  }
+}
+
+void latencyFrameSent(uint8_t module)
+{
+  if (module >= NUM_MODULES || !pendingFrameValid[module])
+    return;
+
+  pendingFrameValid[module] = false;
+  latencyRecord(module, pendingFrame[module]);
+}
+
+static void latencyTxComplete0()
+{
+  latencyFrameSent(0);
+}
+
+#if NUM_MODULES > 1
+static void latencyTxComplete1()
+{
+  latencyFrameSent(1);
+}
+#endif
+
+static void (* const latencyTxCompleteCallbacks[NUM_MODULES])() = {
+  latencyTxComplete0,
+#if NUM_MODULES > 1
+  latencyTxComplete1,
+#endif
+};
+
+void latencyAttachModule(uint8_t module)
+{
+  if (module >= NUM_MODULES)
+    return;
+
+  txCompleteAttached[module] = false;
+  pendingFrameValid[module] = false;
+
+  auto st = modulePortGetState(module);
+  if (!st || !st->tx.port || st->tx.port->type != ETX_MOD_TYPE_SERIAL)
+    return;
+
+  auto drv = st->tx.port->drv.serial;
+  if (!drv || !drv->setTxCompleteCb)
+    return;
+
+  drv->setTxCompleteCb(st->tx.ctx, latencyActive ? latencyTxCompleteCallbacks[module] : nullptr);
+  txCompleteAttached[module] = latencyActive;
+}
+
+void latencyMeasureReset()
+{
+  memclear(latencyStats, sizeof(latencyStats));
+}
+
+void latencyMeasureStart()
+{
+  latencyMeasureReset();
+  latencyActive = true;
+  for (uint8_t module = 0; module < NUM_MODULES; module++) {
+    latencyAttachModule(module);
+  }
+}
+
+void latencyMeasureStop()
+{
+  latencyActive = false;
+  for (uint8_t module = 0; module < NUM_MODULES; module++) {
+    latencyAttachModule(module);
+  }
+}
+
+bool latencyMeasureActive()
+{
+  return latencyActive;
+}
+
+void latencyAdcSampled()
+{
+  if (latencyActive)
+    latencyTimestamp(adcSample);
+}
+
+void latencyOutputsComputed()
+{
+  if (latencyActive)
+    outputsSample = adcSample;
+}
+
+const LatencyTimestamp & latencyOutputsTimestamp()
+{
+  return outputsSample;
+}
+
+void latencyFrameQueued(uint8_t module, const LatencyTimestamp & sampled)
+{
+  if (!latencyActive || module >= NUM_MODULES)
+    return;
+
+  pendingFrame[module] = sampled;
+  pendingFrameValid[module] = true;
+
+  if (!txCompleteAttached[module]) {
+    // no notification from the port: measure up to here
+    latencyFrameSent(module);
+  }
+}
+
+const ModuleLatencyStats & latencyGetStats(uint8_t module)
+{
+  return latencyStats[module];
+}
+
+uint16_t latencyAverage(uint8_t module)
+{
+  const ModuleLatencyStats & stats = latencyStats[module];
+  return stats.count ? stats.sum / stats.count : 0;
+}
+
+// Returns the upper bound of the bucket holding the given percentile, in us
+uint16_t latencyPercentile(uint8_t module, uint8_t percent)
+{
+  const ModuleLatencyStats & stats = latencyStats[module];
+
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+    total += stats.buckets[i];
+  }
+  if (!total)
+    return 0;
+
+  uint32_t threshold = (total * percent + 99) / 100;
+  uint32_t count = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS - 1; i++) {
+    count += stats.buckets[i];
+    if (count >= threshold)
+      return min<uint16_t>((i + 1) * LATENCY_BUCKET_US, stats.max);
+  }
+  return stats.max;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include "dataconstants.h"
+#include "opentx_types.h"
+
+// Stick to RF latency measurement
+//
+// The ADC sample time is carried along with the channel outputs computed
+// from it, and the delay is recorded when the module driver has finished
+// sending the frame holding them. Ports without a TX complete notification
+// (timers, soft-serial) record it when the frame is handed to the driver.
+
+// Time the inputs of a set of channel outputs were sampled
+struct LatencyTimestamp {
+  uint16_t tmr2MHz;
+  tmr10ms_t tmr10ms;
+};
+
+// 100us buckets, the last one includes everything above
+constexpr uint8_t LATENCY_BUCKETS = 128;
+constexpr uint16_t LATENCY_BUCKET_US = 100;
+
+struct ModuleLatencyStats {
+  uint32_t count;
+  uint64_t sum;  // us
+  uint16_t min;  // us
+  uint16_t max;  // us
+  bool txComplete; // measured on TX complete (otherwise on frame queued)
+  uint16_t buckets[LATENCY_BUCKETS];
+};
+
+void latencyMeasureStart();
+void latencyMeasureStop();
+bool latencyMeasureActive();
+void latencyMeasureReset();
+
+// mixer task side
+void latencyAdcSampled();
+void latencyOutputsComputed();
+const LatencyTimestamp & latencyOutputsTimestamp();
+void latencyFrameQueued(uint8_t module, const LatencyTimestamp & sampled);
+void latencyFrameSent(uint8_t module);
+
+// to be called once the module port has been (re)initialised
+void latencyAttachModule(uint8_t module);
+
+const ModuleLatencyStats & latencyGetStats(uint8_t module);
+uint16_t latencyAverage(uint8_t module);
+uint16_t latencyPercentile(uint8_t module, uint8_t percent);
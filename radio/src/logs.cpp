@@ -21,6 +21,12 @@
 
 #include "opentx.h"
 #include "ff.h"
+#include "tasks.h"
+#include "logs_queue.h"
+
+#if defined(LOG_BINARY)
+  #include "logs_binary.h"
+#endif
 
 #if defined(LIBOPENUI)
   #include "libopenui.h"
@@ -97,6 +103,136 @@ void initLoggingTimer() {                                       // called cyclic
 
 void writeHeader();
 
+// The rows are formatted by logsWrite() into the queue, each one as a
+// whole or dropped when the queue is full, and written to the file by
+// the logs task, by chunks ending on a sector boundary of the file
+#define LOGS_QUEUE_SIZE      4096
+#define LOGS_SECTOR_SIZE     512
+
+enum LogsState {
+  LOGS_IDLE,
+  LOGS_RUNNING,  // the header and the rows are queued
+  LOGS_CLOSING,  // the file is closed once the queue is written
+};
+
+static LogsQueue<LOGS_QUEUE_SIZE> logsQueue;
+static volatile uint8_t logsState = LOGS_IDLE;
+static uint16_t logsHeaderSize;
+static const char * volatile logsError;
+static LogsStats logsStats;
+
+// Held by the logs task while it works and by logsClose(), the
+// logging timer only tries to get it when a file starts or ends
+static RTOS_MUTEX_HANDLE logsMutex;
+
+RTOS_TASK_HANDLE logsTaskId;
+RTOS_DEFINE_STACK(logsTaskId, logsStack, LOGS_STACK_SIZE);
+
+// Wakes the logs task up, it sleeps while there is nothing to write
+static void logsNotify()
+{
+#if !defined(SIMU)
+  xTaskNotifyGive(logsTaskId.rtos_handle);
+#endif
+}
+
+static void logsPut(const void * data, uint32_t len)
+{
+  logsQueue.put((const uint8_t *)data, len);
+}
+
+#if defined(LOG_BINARY)
+#define LOGS_LABEL_MAXLEN    32
+#define LOGS_MAX_VALUES      (2 + 2 * MAX_TELEMETRY_SENSORS + \
+                              NUM_STICKS + NUM_POTS + NUM_SLIDERS + \
+                              NUM_SWITCHES + 2 + MAX_OUTPUT_CHANNELS + 1)
+
+// Values of the previous row, the deltas are computed from
+static int32_t logsPrevValues[LOGS_MAX_VALUES];
+static uint16_t logsValueIndex;
+
+// A dropped row breaks the deltas, the next one comes after a new header
+static bool logsHeaderNeeded;
+
+static void logsPutByte(uint8_t byte)
+{
+  logsPut(&byte, 1);
+}
+
+static void logsPutVarint(uint32_t value)
+{
+  uint8_t data[LOG_BINARY_VARINT_MAXLEN];
+  logsPut(data, logBinaryPutVarint(data, value));
+}
+
+static void logsPutValue(int32_t value)
+{
+  if (logsValueIndex >= LOGS_MAX_VALUES)
+    return;
+  int32_t & prev = logsPrevValues[logsValueIndex++];
+  logsPutVarint(logBinaryZigzag(int32_t(uint32_t(value) - uint32_t(prev))));
+  prev = value;
+}
+
+static void logsPutText(const char * text)
+{
+  if (logsValueIndex >= LOGS_MAX_VALUES)
+    return;
+
+  // only a hash of the previous text is kept
+  uint8_t len = strnlen(text, TELEMETRY_SENSOR_TEXT_LENGTH);
+  uint32_t hash = 5381;
+  for (uint8_t i = 0; i < len; i++) {
+    hash = ((hash << 5) + hash) + (uint8_t)text[i];
+  }
+
+  int32_t & prev = logsPrevValues[logsValueIndex++];
+  if ((int32_t)hash == prev) {
+    logsPutVarint(0);
+  }
+  else {
+    logsPutVarint(len + 1);
+    logsPut(text, len);
+    prev = hash;
+  }
+}
+
+static void logsPutField(uint8_t kind, uint8_t prec, const char * label)
+{
+  uint8_t len = strnlen(label, LOGS_LABEL_MAXLEN);
+  uint8_t field[3] = { kind, prec, len };
+  logsPut(field, sizeof(field));
+  logsPut(label, len);
+}
+#else
+static void logsPutString(const char * s)
+{
+  logsPut(s, strlen(s));
+}
+
+// value with prec decimals, followed by the separator
+static void logsPutNumber(int32_t value, uint8_t prec = 0, char separator = ',')
+{
+  char s[16];
+  char * tmp = s;
+  uint32_t absolute = abs(value);
+  if (value < 0) {
+    *tmp++ = '-';
+  }
+  if (prec > 0) {
+    uint32_t divisor = (prec == 6 ? 1000000 : prec == 2 ? 100 : 10);
+    tmp = strAppendUnsigned(tmp, absolute / divisor);
+    *tmp++ = '.';
+    tmp = strAppendUnsigned(tmp, absolute % divisor, prec);
+  }
+  else {
+    tmp = strAppendUnsigned(tmp, absolute);
+  }
+  *tmp++ = separator;
+  logsPut(s, tmp - s);
+}
+#endif
+
 #if defined(PCBFRSKY) || defined(PCBNV14)
   int getSwitchState(uint8_t swtch) {
     int value = getValue(MIXSRC_FIRST_SWITCH + swtch);
@@ -168,27 +304,131 @@ const char * logsOpen()
   tmp = strAppendDate(tmp, true);
 #endif
 
+#if defined(LOG_BINARY)
+  strcpy(tmp, LOGS_BINARY_EXT);
+#else
   strcpy(tmp, STR_LOGS_EXT);
+#endif
 
   result = f_open(&g_oLogFile, filename, FA_OPEN_ALWAYS | FA_WRITE | FA_OPEN_APPEND);
   if (result != FR_OK) {
     return SDCARD_ERROR(result);
   }
 
-  if (f_size(&g_oLogFile) == 0) {
-    writeHeader();
+#if !defined(LOG_BINARY)
+  // the binary logs have a header each time the deltas start again
+  if (f_size(&g_oLogFile) != 0) {
+    logsQueue.skip(logsHeaderSize);
   }
+#endif
 
   return nullptr;
 }
 
+static void logsCloseFile()
+{
+  if (f_close(&g_oLogFile) != FR_OK) {
+    // close failed, forget file
+    g_oLogFile.obj.fs = 0;
+  }
+}
+
+static bool logsFlush(bool all)
+{
+  uint32_t count = logsQueue.size();
+  if (!all) {
+    uint32_t pos = f_tell(&g_oLogFile);
+    uint32_t end = (pos + count) & ~(LOGS_SECTOR_SIZE - 1);
+    if (end <= pos)
+      return true;
+    count = end - pos;
+  }
+
+  uint32_t start = RTOS_GET_MS();
+  while (count > 0) {
+    const uint8_t * data;
+    uint32_t len = min<uint32_t>(logsQueue.readSpan(&data), count);
+    UINT written;
+    if (f_write(&g_oLogFile, data, len, &written) != FR_OK || written != len)
+      return false;
+    logsQueue.skip(len);
+    count -= len;
+  }
+
+  uint32_t duration = RTOS_GET_MS() - start;
+  if (duration > logsStats.maxWriteDuration)
+    logsStats.maxWriteDuration = duration;
+  return true;
+}
+
+static void logsProcessQueue()
+{
+  if (logsState == LOGS_IDLE)
+    return;
+
+  const char * error = nullptr;
+  if (!g_oLogFile.obj.fs) {
+    error = logsOpen();
+  }
+
+  bool closing = (logsState == LOGS_CLOSING);
+  if (!error && !logsFlush(closing)) {
+    error = STR_SDCARD_ERROR;
+  }
+
+  if (error) {
+    // logsWrite() starts a new file
+    logsError = error;
+    if (g_oLogFile.obj.fs) {
+      logsCloseFile();
+    }
+    logsState = LOGS_IDLE;
+  }
+  else if (closing) {
+    logsCloseFile();
+    logsState = LOGS_IDLE;
+  }
+}
+
+// Writes the queued rows, run by the logs task when notified (from the
+// main loop in the simulator)
+void logsProcess()
+{
+  RTOS_LOCK_MUTEX(logsMutex);
+  logsProcessQueue();
+  RTOS_UNLOCK_MUTEX(logsMutex);
+}
+
+#if !defined(SIMU)
+TASK_FUNCTION(logsTask)
+{
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    logsProcess();
+  }
+  TASK_RETURN();
+}
+#endif
+
+void logsTaskInit()
+{
+  RTOS_CREATE_MUTEX(logsMutex);
+#if !defined(SIMU)
+  RTOS_CREATE_TASK(logsTaskId, logsTask, "logs", logsStack, LOGS_STACK_SIZE,
+                   LOGS_TASK_PRIO);
+#endif
+}
+
 void logsClose()
 {
   if (sdMounted()) {
-    if (f_close(&g_oLogFile) != FR_OK) {
-      // close failed, forget file
-      g_oLogFile.obj.fs = 0;
+    RTOS_LOCK_MUTEX(logsMutex);
+    if (g_oLogFile.obj.fs) {
+      logsFlush(true);
+      logsCloseFile();
     }
+    logsState = LOGS_IDLE;
+    RTOS_UNLOCK_MUTEX(logsMutex);
     lastLogTime = 0;
   }
   #if !defined(SIMU)
@@ -196,12 +436,138 @@ void logsClose()
   #endif
 }
 
+// Queues the header of a new file, once the logs task is done with the
+// previous one
+static bool logsStart()
+{
+  if (!RTOS_TRYLOCK_MUTEX(logsMutex))
+    return false;
+
+  bool result = false;
+  if (logsState == LOGS_IDLE) {
+    logsQueue.clear();
+    logsQueue.begin();
+    writeHeader();
+    if (logsQueue.commit()) {
+      logsHeaderSize = logsQueue.size();
+#if defined(LOG_BINARY)
+      logsHeaderNeeded = false;
+#endif
+      logsState = LOGS_RUNNING;
+      result = true;
+    }
+  }
+
+  RTOS_UNLOCK_MUTEX(logsMutex);
+  return result;
+}
+
+// The logs task writes what is queued and closes the file
+static bool logsStop()
+{
+  if (!RTOS_TRYLOCK_MUTEX(logsMutex))
+    return false;
+
+  if (logsState == LOGS_RUNNING) {
+    logsState = LOGS_CLOSING;
+  }
+  logsError = nullptr;
+  lastLogTime = 0;
+
+  RTOS_UNLOCK_MUTEX(logsMutex);
+  logsNotify();
+  return true;
+}
+
+const LogsStats & logsGetStats()
+{
+  return logsStats;
+}
+
+void logsResetStats()
+{
+  memclear(&logsStats, sizeof(logsStats));
+}
+
+#if defined(LOG_BINARY)
+void writeHeader()
+{
+  memclear(logsPrevValues, sizeof(logsPrevValues));
+
+  logsPutByte(LOG_BINARY_TAG_HEADER);
+  for (uint8_t i = 0; i < LOG_BINARY_MAGIC_LEN; i++) {
+    logsPutByte(LOG_BINARY_MAGIC[i]);
+  }
+  logsPutByte(LOG_BINARY_VERSION);
+
+#if defined(RTCLOCK)
+  logsPutField(LOG_FIELD_RTC, 0, "Date,Time");
+#else
+  logsPutField(LOG_FIELD_TIME, 0, "Time");
+#endif
+
+  char label[TELEM_LABEL_LEN+7];
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isTelemetryFieldAvailable(i)) {
+      TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      if (sensor.logs) {
+        memset(label, 0, sizeof(label));
+        strncpy(label, sensor.label, TELEM_LABEL_LEN);
+        uint8_t unit = sensor.unit;
+        if (unit == UNIT_CELLS ) unit = UNIT_VOLTS;
+        if (UNIT_RAW < unit && unit < UNIT_FIRST_VIRTUAL) {
+          strcat(label, "(");
+          strncat(label, STR_VTELEMUNIT[unit], 3);
+          strcat(label, ")");
+        }
+        if (sensor.unit == UNIT_GPS)
+          logsPutField(LOG_FIELD_GPS, 0, label);
+        else if (sensor.unit == UNIT_DATETIME)
+          logsPutField(LOG_FIELD_DATETIME, 0, label);
+        else if (sensor.unit == UNIT_TEXT)
+          logsPutField(LOG_FIELD_TEXT, 0, label);
+        else
+          logsPutField(LOG_FIELD_VALUE, sensor.prec, label);
+      }
+    }
+  }
+
+  for (uint8_t i=1; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS+1; i++) {
+    logsPutField(LOG_FIELD_VALUE, 0, STR_VSRCRAW[i] + 2);
+  }
+
+#if defined(PCBFRSKY) || defined(PCBFLYSKY)
+  for (uint8_t i=0; i<NUM_SWITCHES; i++) {
+    if (SWITCH_EXISTS(i)) {
+      char s[LEN_SWITCH_NAME + 2];
+      *getSwitchName(s, SWSRC_FIRST_SWITCH + i * 3) = '\0';
+      logsPutField(LOG_FIELD_VALUE, 0, s);
+    }
+  }
+  logsPutField(LOG_FIELD_HEX64, 0, "LSW");
+
+  for (uint8_t channel = 0; channel < MAX_OUTPUT_CHANNELS; channel++) {
+    char * s = strAppendUnsigned(strAppend(label, "CH"), channel + 1);
+    strAppend(s, "(us)");
+    logsPutField(LOG_FIELD_VALUE, 0, label);
+  }
+#else
+  static const char * const switches[] = { "THR", "RUD", "ELE", "3POS", "AIL", "GEA", "TRN" };
+  for (auto sw : switches) {
+    logsPutField(LOG_FIELD_VALUE, 0, sw);
+  }
+#endif
+
+  logsPutField(LOG_FIELD_VALUE, 1, "TxBat(V)");
+  logsPutByte(LOG_FIELD_END);
+}
+#else
 void writeHeader()
 {
 #if defined(RTCLOCK)
-  f_puts("Date,Time,", &g_oLogFile);
+  logsPutString("Date,Time,");
 #else
-  f_puts("Time,", &g_oLogFile);
+  logsPutString("Time,");
 #endif
 
 
@@ -220,21 +586,15 @@ void writeHeader()
           strcat(label, ")");
         }
         strcat(label, ",");
-        f_puts(label, &g_oLogFile);
+        logsPutString(label);
       }
     }
   }
 
 #if defined(PCBFRSKY) || defined(PCBNV14)
   for (uint8_t i=1; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS+1; i++) {
-    const char * p = STR_VSRCRAW[i] + 2;
-    size_t len = strlen(p);
-    for (uint8_t j=0; j<len; ++j) {
-      if (!*p) break;
-      f_putc(*p, &g_oLogFile);
-      ++p;
-    }
-    f_putc(',', &g_oLogFile);
+    logsPutString(STR_VSRCRAW[i] + 2);
+    logsPutString(",");
   }
 
   for (uint8_t i=0; i<NUM_SWITCHES; i++) {
@@ -244,20 +604,23 @@ void writeHeader()
       temp = getSwitchName(s, SWSRC_FIRST_SWITCH + i * 3);
       *temp++ = ',';
       *temp = '\0';
-      f_puts(s, &g_oLogFile);
+      logsPutString(s);
     }
   }
-  f_puts("LSW,", &g_oLogFile);
+  logsPutString("LSW,");
   
   for (uint8_t channel = 0; channel < MAX_OUTPUT_CHANNELS; channel++) {
-    f_printf(&g_oLogFile, "CH%d(us),", channel+1);
+    char * s = strAppendUnsigned(strAppend(label, "CH"), channel + 1);
+    strAppend(s, "(us),");
+    logsPutString(label);
   }
 #else
-  f_puts("Rud,Ele,Thr,Ail,P1,P2,P3,THR,RUD,ELE,3POS,AIL,GEA,TRN,", &g_oLogFile);
+  logsPutString("Rud,Ele,Thr,Ail,P1,P2,P3,THR,RUD,ELE,3POS,AIL,GEA,TRN,");
 #endif
 
-  f_puts("TxBat(V)\n", &g_oLogFile);
+  logsPutString("TxBat(V)\n");
 }
+#endif
 
 uint32_t getLogicalSwitchesStates(uint8_t first)
 {
@@ -268,6 +631,194 @@ uint32_t getLogicalSwitchesStates(uint8_t first)
   return result;
 }
 
+#if defined(LOG_BINARY)
+static void writeRow(tmr10ms_t tmr10ms)
+{
+  logsPutByte(LOG_BINARY_TAG_ROW);
+  logsValueIndex = 0;
+
+#if defined(RTCLOCK)
+  (void)tmr10ms;
+  logsPutValue(g_rtcTime);
+  logsPutValue(g_ms100);
+#else
+  logsPutValue(tmr10ms);
+#endif
+
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isTelemetryFieldAvailable(i)) {
+      TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      TelemetryItem & telemetryItem = telemetryItems[i];
+      if (sensor.logs) {
+        if (sensor.unit == UNIT_GPS) {
+          logsPutValue(telemetryItem.gps.latitude);
+          logsPutValue(telemetryItem.gps.longitude);
+        }
+        else if (sensor.unit == UNIT_DATETIME) {
+          logsPutValue(telemetryItem.datetime.year * 10000 + telemetryItem.datetime.month * 100 + telemetryItem.datetime.day);
+          logsPutValue(telemetryItem.datetime.hour * 10000 + telemetryItem.datetime.min * 100 + telemetryItem.datetime.sec);
+        }
+        else if (sensor.unit == UNIT_TEXT) {
+          logsPutText(telemetryItem.text);
+        }
+        else {
+          logsPutValue(telemetryItem.value);
+        }
+      }
+    }
+  }
+
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    logsPutValue(calibratedAnalogs[i]);
+  }
+
+#if defined(PCBFRSKY) || defined(PCBFLYSKY)
+  for (uint8_t i=0; i<NUM_SWITCHES; i++) {
+    if (SWITCH_EXISTS(i)) {
+      logsPutValue(getSwitchState(i));
+    }
+  }
+  logsPutValue(getLogicalSwitchesStates(32));
+  logsPutValue(getLogicalSwitchesStates(0));
+
+  for (uint8_t channel = 0; channel < MAX_OUTPUT_CHANNELS; channel++) {
+    logsPutValue(PPM_CENTER+channelOutputs[channel]/2); // in us
+  }
+#else
+  logsPutValue(GET_2POS_STATE(THR));
+  logsPutValue(GET_2POS_STATE(RUD));
+  logsPutValue(GET_2POS_STATE(ELE));
+  logsPutValue(GET_3POS_STATE(ID));
+  logsPutValue(GET_2POS_STATE(AIL));
+  logsPutValue(GET_2POS_STATE(GEA));
+  logsPutValue(GET_2POS_STATE(TRN));
+#endif
+
+  logsPutValue(g_vbat100mV);
+}
+#else
+static void logsPutHex(uint32_t value)
+{
+  char s[8];
+  for (int8_t i = 7; i >= 0; i--) {
+    uint8_t digit = value & 0x0F;
+    s[i] = (digit >= 10 ? 'A' - 10 : '0') + digit;
+    value >>= 4;
+  }
+  logsPut(s, sizeof(s));
+}
+
+static void writeRow(tmr10ms_t tmr10ms)
+{
+#if defined(RTCLOCK)
+  (void)tmr10ms;
+  {
+    static struct gtm utm;
+    static gtime_t lastRtcTime = 0;
+    if (g_rtcTime != lastRtcTime) {
+      lastRtcTime = g_rtcTime;
+      gettime(&utm);
+    }
+    char s[32];
+    char * tmp = strAppendUnsigned(s, utm.tm_year + TM_YEAR_BASE, 4);
+    *tmp++ = '-';
+    tmp = strAppendUnsigned(tmp, utm.tm_mon + 1, 2);
+    *tmp++ = '-';
+    tmp = strAppendUnsigned(tmp, utm.tm_mday, 2);
+    *tmp++ = ',';
+    tmp = strAppendUnsigned(tmp, utm.tm_hour, 2);
+    *tmp++ = ':';
+    tmp = strAppendUnsigned(tmp, utm.tm_min, 2);
+    *tmp++ = ':';
+    tmp = strAppendUnsigned(tmp, utm.tm_sec, 2);
+    *tmp++ = '.';
+    tmp = strAppendUnsigned(tmp, g_ms100, 2);
+    strAppend(tmp, "0,");
+    logsPutString(s);
+  }
+#else
+  logsPutNumber(tmr10ms);
+#endif
+
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isTelemetryFieldAvailable(i)) {
+      TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      TelemetryItem & telemetryItem = telemetryItems[i];
+      if (sensor.logs) {
+        if (sensor.unit == UNIT_GPS) {
+          if (telemetryItem.gps.longitude && telemetryItem.gps.latitude) {
+            logsPutNumber(telemetryItem.gps.latitude, 6, ' ');
+            logsPutNumber(telemetryItem.gps.longitude, 6);
+          }
+          else {
+            logsPutString(",");
+          }
+        }
+        else if (sensor.unit == UNIT_DATETIME) {
+          char s[24];
+          char * tmp = s;
+          // the year is padded with spaces to 4 characters
+          for (uint16_t limit = 1000; limit > 1 && telemetryItem.datetime.year < limit; limit /= 10) {
+            *tmp++ = ' ';
+          }
+          tmp = strAppendUnsigned(tmp, telemetryItem.datetime.year);
+          *tmp++ = '-';
+          tmp = strAppendUnsigned(tmp, telemetryItem.datetime.month, 2);
+          *tmp++ = '-';
+          tmp = strAppendUnsigned(tmp, telemetryItem.datetime.day, 2);
+          *tmp++ = ' ';
+          tmp = strAppendUnsigned(tmp, telemetryItem.datetime.hour, 2);
+          *tmp++ = ':';
+          tmp = strAppendUnsigned(tmp, telemetryItem.datetime.min, 2);
+          *tmp++ = ':';
+          tmp = strAppendUnsigned(tmp, telemetryItem.datetime.sec, 2);
+          strAppend(tmp, ",");
+          logsPutString(s);
+        }
+        else if (sensor.unit == UNIT_TEXT) {
+          logsPutString("\"");
+          logsPut(telemetryItem.text, strnlen(telemetryItem.text, TELEMETRY_SENSOR_TEXT_LENGTH));
+          logsPutString("\",");
+        }
+        else {
+          logsPutNumber(telemetryItem.value, sensor.prec);
+        }
+      }
+    }
+  }
+
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    logsPutNumber(calibratedAnalogs[i]);
+  }
+
+#if defined(PCBFRSKY) || defined(PCBFLYSKY)
+  for (uint8_t i=0; i<NUM_SWITCHES; i++) {
+    if (SWITCH_EXISTS(i)) {
+      logsPutNumber(getSwitchState(i));
+    }
+  }
+  logsPutString("0x");
+  logsPutHex(getLogicalSwitchesStates(32));
+  logsPutHex(getLogicalSwitchesStates(0));
+  logsPutString(",");
+
+  for (uint8_t channel = 0; channel < MAX_OUTPUT_CHANNELS; channel++) {
+    logsPutNumber(PPM_CENTER+channelOutputs[channel]/2); // in us
+  }
+#else
+  logsPutNumber(GET_2POS_STATE(THR));
+  logsPutNumber(GET_2POS_STATE(RUD));
+  logsPutNumber(GET_2POS_STATE(ELE));
+  logsPutNumber(GET_3POS_STATE(ID));
+  logsPutNumber(GET_2POS_STATE(AIL));
+  logsPutNumber(GET_2POS_STATE(GEA));
+  logsPutNumber(GET_2POS_STATE(TRN));
+#endif
+
+  logsPutNumber(abs(g_vbat100mV), 1, '\n');
+}
+#endif
+
 void logsWrite()
 {
   static const char * error_displayed = nullptr;
@@ -283,114 +834,51 @@ void logsWrite()
       lastLogTime = tmr10ms;
     #else
     {
+      tmr10ms_t tmr10ms = 0;
     #endif
 
-      if (!g_oLogFile.obj.fs) {
-        const char * result = logsOpen();
-        if (result) {
-          if (result != error_displayed) {
-            error_displayed = result;
-            POPUP_WARNING(result);
-          }
-          return;
-        }
-      }
-
-#if defined(RTCLOCK)
-      {
-        static struct gtm utm;
-        static gtime_t lastRtcTime = 0;
-        if (g_rtcTime != lastRtcTime) {
-          lastRtcTime = g_rtcTime;
-          gettime(&utm);
-        }
-        f_printf(&g_oLogFile, "%4d-%02d-%02d,%02d:%02d:%02d.%02d0,", utm.tm_year+TM_YEAR_BASE, utm.tm_mon+1, utm.tm_mday, utm.tm_hour, utm.tm_min, utm.tm_sec, g_ms100);
-      }
-#else
-      f_printf(&g_oLogFile, "%d,", tmr10ms);
-#endif
-
-      for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
-        if (isTelemetryFieldAvailable(i)) {
-          TelemetrySensor & sensor = g_model.telemetrySensors[i];
-          TelemetryItem & telemetryItem = telemetryItems[i];
-          if (sensor.logs) {
-            if (sensor.unit == UNIT_GPS) {
-              if (telemetryItem.gps.longitude && telemetryItem.gps.latitude) {
-                div_t qr = div((int)telemetryItem.gps.latitude, 1000000);
-                if (telemetryItem.gps.latitude < 0) f_printf(&g_oLogFile, "-");
-                f_printf(&g_oLogFile, "%d.%06d ", abs(qr.quot), abs(qr.rem));
-                qr = div((int)telemetryItem.gps.longitude, 1000000);
-                if (telemetryItem.gps.longitude < 0) f_printf(&g_oLogFile, "-");
-                f_printf(&g_oLogFile, "%d.%06d,", abs(qr.quot), abs(qr.rem));
-              }
-              else {
-                f_printf(&g_oLogFile, ",");
-              }
-            }
-            else if (sensor.unit == UNIT_DATETIME) {
-              f_printf(&g_oLogFile, "%4d-%02d-%02d %02d:%02d:%02d,", telemetryItem.datetime.year, telemetryItem.datetime.month, telemetryItem.datetime.day, telemetryItem.datetime.hour, telemetryItem.datetime.min, telemetryItem.datetime.sec);
-            }
-            else if (sensor.unit == UNIT_TEXT) {
-              f_printf(&g_oLogFile, "\"%s\",", telemetryItem.text);
-            }
-            else if (sensor.prec == 2) {
-              div_t qr = div((int)telemetryItem.value, 100);
-              if (telemetryItem.value < 0) f_printf(&g_oLogFile, "-");
-              f_printf(&g_oLogFile, "%d.%02d,", abs(qr.quot), abs(qr.rem));
-            }
-            else if (sensor.prec == 1) {
-              div_t qr = div((int)telemetryItem.value, 10);
-              if (telemetryItem.value < 0) f_printf(&g_oLogFile, "-");
-              f_printf(&g_oLogFile, "%d.%d,", abs(qr.quot), abs(qr.rem));
-            }
-            else {
-              f_printf(&g_oLogFile, "%d,", telemetryItem.value);
-            }
-          }
-        }
+      const char * error = logsError;
+      if (error && error != error_displayed) {
+        error_displayed = error;
+        POPUP_WARNING(error);
       }
 
-      for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
-        f_printf(&g_oLogFile, "%d,", calibratedAnalogs[i]);
+      if (logsState != LOGS_RUNNING && !logsStart()) {
+        return;
       }
 
-#if defined(PCBFRSKY) || defined(PCBFLYSKY)
-      for (uint8_t i=0; i<NUM_SWITCHES; i++) {
-        if (SWITCH_EXISTS(i)) {
-          f_printf(&g_oLogFile, "%d,", getSwitchState(i));
-        }
+      logsQueue.begin();
+#if defined(LOG_BINARY)
+      if (logsHeaderNeeded) {
+        writeHeader();
       }
-      f_printf(&g_oLogFile, "0x%08X%08X,", getLogicalSwitchesStates(32), getLogicalSwitchesStates(0));
-
-      for (uint8_t channel = 0; channel < MAX_OUTPUT_CHANNELS; channel++) {
-        f_printf(&g_oLogFile, "%d,", PPM_CENTER+channelOutputs[channel]/2); // in us
+#endif
+      writeRow(tmr10ms);
+
+      if (logsQueue.commit()) {
+        logsStats.rows++;
+        uint32_t depth = logsQueue.size();
+        if (depth > logsStats.maxQueueDepth)
+          logsStats.maxQueueDepth = depth;
+#if defined(LOG_BINARY)
+        logsHeaderNeeded = false;
+#endif
+        logsNotify();
       }
-#else
-      f_printf(&g_oLogFile, "%d,%d,%d,%d,%d,%d,%d,",
-          GET_2POS_STATE(THR),
-          GET_2POS_STATE(RUD),
-          GET_2POS_STATE(ELE),
-          GET_3POS_STATE(ID),
-          GET_2POS_STATE(AIL),
-          GET_2POS_STATE(GEA),
-          GET_2POS_STATE(TRN));
+      else {
+        logsStats.droppedRows++;
+#if defined(LOG_BINARY)
+        logsHeaderNeeded = true;
 #endif
-
-      div_t qr = div(g_vbat100mV, 10);
-      int result = f_printf(&g_oLogFile, "%d.%d\n", abs(qr.quot), abs(qr.rem));
-
-      if (result<0 && !error_displayed) {
-        error_displayed = STR_SDCARD_ERROR;
-        POPUP_WARNING(STR_SDCARD_ERROR);
-        logsClose();
       }
     }
   }
   else {
     error_displayed = nullptr;
-    if (g_oLogFile.obj.fs) {
-      logsClose();
+    if (logsState == LOGS_RUNNING && logsStop()) {
+      #if !defined(SIMU)
+      loggingTimerStop();
+      #endif
     }
   }
 }
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Binary flight logs (LOG_BINARY option), converted back to the CSV
+// logs by Companion. This header is shared with Companion.
+//
+// A log is a sequence of records, each one starting with a tag:
+//
+//  - LOG_BINARY_TAG_HEADER, written each time the file is opened:
+//    the magic, the version, then the fields as (kind, prec, label
+//    length, label), ended by a LOG_FIELD_END kind. A field gives
+//    one CSV column (two for LOG_FIELD_RTC, whose label holds both).
+//
+//  - LOG_BINARY_TAG_ROW: the values of each field in header order.
+//    A value is stored as the zigzag varint of its difference with
+//    the same value in the previous row (0 before the first row), so
+//    that an unchanged value takes a single byte.
+//    LOG_FIELD_TEXT is a varint of 0 when unchanged, of the length + 1
+//    followed by the text otherwise.
+
+#define LOG_BINARY_MAGIC       "ETXL"
+#define LOG_BINARY_MAGIC_LEN   4
+#define LOG_BINARY_VERSION     1
+
+#define LOG_BINARY_TAG_HEADER  'H'
+#define LOG_BINARY_TAG_ROW     'R'
+
+enum LogFieldKind {
+  LOG_FIELD_END,
+  LOG_FIELD_TIME,      // 10ms ticks
+  LOG_FIELD_RTC,       // seconds since 1970, then 10ms in the second
+  LOG_FIELD_VALUE,     // number with prec decimals
+  LOG_FIELD_GPS,       // latitude then longitude, in 1/1000000 degree
+  LOG_FIELD_DATETIME,  // yyyymmdd then hhmmss
+  LOG_FIELD_TEXT,
+  LOG_FIELD_HEX64,     // high then low 32 bits
+};
+
+inline uint8_t logFieldValuesCount(uint8_t kind)
+{
+  switch (kind) {
+    case LOG_FIELD_RTC:
+    case LOG_FIELD_GPS:
+    case LOG_FIELD_DATETIME:
+    case LOG_FIELD_HEX64:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+// Largest encoded varint
+#define LOG_BINARY_VARINT_MAXLEN  5
+
+inline uint8_t logBinaryPutVarint(uint8_t * dest, uint32_t value)
+{
+  uint8_t len = 0;
+  while (value >= 0x80) {
+    dest[len++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  dest[len++] = value;
+  return len;
+}
+
+// Returns the number of bytes read, 0 if the data is truncated
+inline uint8_t logBinaryGetVarint(const uint8_t * src, uint32_t size, uint32_t & value)
+{
+  value = 0;
+  for (uint8_t len = 0; len < LOG_BINARY_VARINT_MAXLEN && len < size; len++) {
+    value |= uint32_t(src[len] & 0x7F) << (7 * len);
+    if (!(src[len] & 0x80))
+      return len + 1;
+  }
+  return 0;
+}
+
+inline uint32_t logBinaryZigzag(int32_t value)
+{
+  return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+
+inline int32_t logBinaryUnzigzag(uint32_t value)
+{
+  return int32_t(value >> 1) ^ -int32_t(value & 1);
+}
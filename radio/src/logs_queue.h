@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include "fifo.h"
+
+// Queue of the flight log rows, filled by the logging timer and written
+// to the file by the logs task. The data put since begin() is only seen
+// by the reader once committed, and a row which does not fit is dropped
+// as a whole.
+template <int N>
+class LogsQueue: public Fifo<uint8_t, N>
+{
+  public:
+    void begin()
+    {
+      pending = this->widx;
+      overflow = false;
+    }
+
+    void put(const uint8_t * data, uint32_t len)
+    {
+      uint32_t used = (N + pending - this->ridx) & (N - 1);
+      if (overflow || used + len >= N) {
+        overflow = true;
+        return;
+      }
+      while (len--) {
+        this->fifo[pending] = *data++;
+        pending = this->nextIndex(pending);
+      }
+    }
+
+    // makes the data put since begin() visible to the reader,
+    // returns false if it was dropped
+    bool commit()
+    {
+      if (overflow)
+        return false;
+      this->widx = pending;
+      return true;
+    }
+
+  protected:
+    uint32_t pending = 0;
+    bool overflow = false;
+};
@@ -28,6 +28,7 @@
 #include "lua_api.h"
 #include "api_filesystem.h"
 #include "hal/module_port.h"
+#include "mixer_stats.h"
 
 #if defined(LIBOPENUI)
   #include "libopenui.h"
@@ -2039,6 +2040,59 @@ static int luaGetAvailableMemory(lua_State * L)
   return 1;
 }
 
+/*luadoc
+@function getMixerStats([reset])
+
+Returns the time spent in each stage of the mixer task.
+
+@param reset (optional) when true, the statistics are cleared after being read
+
+@retval table indexed by stage name (`adc`, `switches`, `inputs`, `mixes`,
+`functions`, `limits`, `pulses`, `total`), each one a table with elements:
+ * `count` (number) number of mixer cycles measured
+ * `last` (number) duration of the last cycle in us
+ * `avg` (number) average duration in us
+ * `p50` (number) median duration in us (upper bound of the histogram bucket)
+ * `p99` (number) 99th percentile in us (upper bound of the histogram bucket)
+ * `max` (number) maximum duration in us
+ * `histogram` (table) cycles count per bucket, bucket `n` holding the
+ durations from 2^(n-1) to 2^n - 1 us
+
+@status current Introduced in 2.9.0
+*/
+static int luaGetMixerStats(lua_State * L)
+{
+  bool reset = lua_toboolean(L, 1);
+
+  lua_newtable(L);
+  for (uint8_t stage = 0; stage < MIXER_STAGE_COUNT; stage++) {
+    const MixerStageStats & stats = mixerStatsGet(stage);
+    lua_pushstring(L, mixerStageNames[stage]);
+    lua_newtable(L);
+    lua_pushtableinteger(L, "count", stats.count);
+    lua_pushtableinteger(L, "last", stats.last);
+    lua_pushtableinteger(L, "avg", mixerStatsAverage(stage));
+    lua_pushtableinteger(L, "p50", mixerStatsPercentile(stage, 50));
+    lua_pushtableinteger(L, "p99", mixerStatsPercentile(stage, 99));
+    lua_pushtableinteger(L, "max", stats.max);
+    lua_pushstring(L, "histogram");
+    lua_newtable(L);
+    for (uint8_t bucket = 0; bucket < MIXER_STATS_BUCKETS; bucket++) {
+      lua_pushinteger(L, bucket + 1);
+      lua_pushinteger(L, stats.buckets[bucket]);
+      lua_settable(L, -3);
+    }
+    lua_settable(L, -3);
+    lua_settable(L, -3);
+  }
+
+  if (reset) {
+    mixerStatsReset();
+  }
+
+  return 1;
+}
+
 /*luadoc
 @function resetGlobalTimer([type])
 
@@ -2760,6 +2814,7 @@ LROT_BEGIN(etxlib, NULL, 0)
   LROT_FUNCENTRY( loadScript, luaLoadScript )
   LROT_FUNCENTRY( getUsage, luaGetUsage )
   LROT_FUNCENTRY( getAvailableMemory, luaGetAvailableMemory )
+  LROT_FUNCENTRY( getMixerStats, luaGetMixerStats )
   LROT_FUNCENTRY( resetGlobalTimer, luaResetGlobalTimer )
 #if LCD_DEPTH > 1 && !defined(COLORLCD)
   LROT_FUNCENTRY( GREY, luaGrey )
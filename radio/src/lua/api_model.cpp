@@ -28,6 +28,7 @@
 #include "../timers.h"
 #include "model_init.h"
 #include "gvars.h"
+#include "tasks/mixer_task.h"
 
 #if defined(SDCARD_YAML)
 #include <storage/sdcard_yaml.h>
@@ -444,6 +445,7 @@ Clear all flightModes
 static int luaModelDeleteFlightModes(lua_State *L)
 {
   memset(g_model.flightModeData, 0, sizeof(g_model.flightModeData));
+  storageDirty(EE_MODEL);
   return 0;
 }
 
@@ -689,6 +691,7 @@ static int luaModelInsertInput(lua_State *L)
         expo->flightModes = luaL_checkinteger(L, -1);
       }
     }
+    storageDirty(EE_MODEL);
   }
 
   return 0;
@@ -730,6 +733,7 @@ Delete all Inputs
 static int luaModelDeleteInputs(lua_State *L)
 {
   clearInputs();
+  storageDirty(EE_MODEL);
   return 0;
 }
 
@@ -744,6 +748,7 @@ static int luaModelDefaultInputs(lua_State *L)
 {
   clearInputs();
   setDefaultInputs();
+  storageDirty(EE_MODEL);
   return 0;
 }
 
@@ -931,6 +936,7 @@ static int luaModelInsertMix(lua_State *L)
         mix->speedDown = luaL_checkinteger(L, -1);
       }
     }
+    storageDirty(EE_MODEL);
   }
 
   return 0;
@@ -971,7 +977,10 @@ Remove all mixers
 */
 static int luaModelDeleteMixes(lua_State *L)
 {
+  mixerTaskStop();
   memset(g_model.mixData, 0, sizeof(g_model.mixData));
+  mixerTaskStart();
+  storageDirty(EE_MODEL);
   return 0;
 }
 
@@ -32,6 +32,10 @@
   #include "cli.h"
 #endif
 
+#if defined(STORAGE_MODELSLIST)
+  #include "storage/modelslist.h"
+#endif
+
 uint8_t currentSpeakerVolume = 255;
 uint8_t requiredSpeakerVolume = 255;
 uint8_t currentBacklightBright = 0;
@@ -288,6 +292,12 @@ void checkEeprom()
   if (TIME_TO_WRITE()) {
     storageCheck(false);
   }
+#if defined(STORAGE_MODELSLIST)
+  else {
+    // models left out of sync with labels.yml at boot, one per cycle
+    modelslist.fetchNextModelCell();
+  }
+#endif
 }
 #endif
 
@@ -503,6 +513,7 @@ void perMain()
       initLoggingTimer();  // initialize software timer for logging
     #else
       logsWrite();         // call logsWrite the old way for simu
+      logsProcess();       // and write the rows, there is no logs task
     #endif
   }
 
@@ -513,6 +524,7 @@ void perMain()
 #endif
 
   checkTrainerSettings();
+  curvesLutUpdate();
   periodicTick();
   DEBUG_TIMER_STOP(debugTimerPerMain1);
 
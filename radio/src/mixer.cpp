@@ -22,6 +22,8 @@
 #include "opentx.h"
 #include "timers.h"
 #include "switches.h"
+#include "mixer_plan.h"
+#include "mixer_stats.h"
 
 uint8_t s_mixer_first_run_done = false;
 
@@ -216,6 +218,50 @@ void applyExpos(int16_t * anas, uint8_t mode, uint8_t ovwrIdx, int16_t ovwrValue
 // a bulletproof implementation would take about additional 100bytes flash
 // therefore with go with this compromize, interested people could activate this define
 
+static inline int32_t applyLimitsCurve(int8_t curve, int32_t value)
+{
+  if (curve) {
+    // TODO we loose precision here, applyCustomCurve could work with int32_t on ARM boards...
+    if (curve > 0)
+      value = 256 * applyCustomCurve(value/256, curve-1);
+    else
+      value = 256 * applyCustomCurve(-value/256, -curve-1);
+  }
+  return value;
+}
+
+// Scales the value between the offset and min / max, the gains being
+// the ranges above and below the offset
+static inline int16_t applyLimitsScale(int32_t value, int16_t ofs,
+                                       int16_t lim_p, int16_t lim_n,
+                                       int16_t gainPos, int16_t gainNeg)
+{
+  // because the rescaling optimization would reduce the calculation reserve we activate this for all builds
+  // it increases the calculation reserve from factor 20,25x to 32x, which it slightly better as original
+  // without it we would only have 16x which is slightly worse as original, we should not do this
+
+  // thanks to gbirkus, he motivated this change, which greatly reduces overruns
+  // unfortunately the constants and 32bit compares generates about 50 bytes codes; didn't find a way to get it down.
+  value = limit(int32_t(-RESXl*256), value, int32_t(RESXl*256));  // saves 2 bytes compared to other solutions up to now
+
+  if (value) {
+    int16_t tmp = (value > 0) ? gainPos : gainNeg;
+    value = (int32_t) value * tmp;   //  div by 1024*256 -> output = -1024..1024
+
+    // Round away from 0
+    tmp = (value + (value < 0 ? (1<<17)-1 : (1<<17))) >> 18;
+
+    ofs += tmp;  // ofs can to added directly because already recalculated,
+  }
+
+  if (ofs > lim_p)
+    ofs = lim_p;
+  if (ofs < lim_n)
+    ofs = lim_n;
+
+  return ofs;
+}
+
 // @@@2 open.20.fsguruh ;
 // channel = channelnumber -1;
 // value = outputvalue with 100 mulitplied usual range -102400 to 102400; output -1024 to 1024
@@ -236,13 +282,7 @@ int16_t applyLimits(uint8_t channel, int32_t value)
 
   LimitData * lim = limitAddress(channel);
 
-  if (lim->curve) {
-    // TODO we loose precision here, applyCustomCurve could work with int32_t on ARM boards...
-    if (lim->curve > 0)
-      value = 256 * applyCustomCurve(value/256, lim->curve-1);
-    else
-      value = 256 * applyCustomCurve(-value/256, -lim->curve-1);
-  }
+  value = applyLimitsCurve(lim->curve, value);
 
   int16_t ofs   = LIMIT_OFS_RESX(lim);
   int16_t lim_p = LIMIT_MAX_RESX(lim);
@@ -251,44 +291,49 @@ int16_t applyLimits(uint8_t channel, int32_t value)
   if (ofs > lim_p) ofs = lim_p;
   if (ofs < lim_n) ofs = lim_n;
 
-  // because the rescaling optimization would reduce the calculation reserve we activate this for all builds
-  // it increases the calculation reserve from factor 20,25x to 32x, which it slightly better as original
-  // without it we would only have 16x which is slightly worse as original, we should not do this
-
-  // thanks to gbirkus, he motivated this change, which greatly reduces overruns
-  // unfortunately the constants and 32bit compares generates about 50 bytes codes; didn't find a way to get it down.
-  value = limit(int32_t(-RESXl*256), value, int32_t(RESXl*256));  // saves 2 bytes compared to other solutions up to now
-
 #if defined(PPM_LIMITS_SYMETRICAL)
-  if (value) {
-    int16_t tmp;
-    if (lim->symetrical)
-      tmp = (value > 0) ? (lim_p) : (-lim_n);
-    else
-      tmp = (value > 0) ? (lim_p - ofs) : (-lim_n + ofs);
-    value = (int32_t) value * tmp;   //  div by 1024*256 -> output = -1024..1024
-#else
-  if (value) {
-    int16_t tmp = (value > 0) ? (lim_p - ofs) : (-lim_n + ofs);
-    value = (int32_t) value * tmp;   //  div by 1024*256 -> output = -1024..1024
+  if (lim->symetrical)
+    ofs = applyLimitsScale(value, ofs, lim_p, lim_n, lim_p, -lim_n);
+  else
 #endif
+    ofs = applyLimitsScale(value, ofs, lim_p, lim_n, lim_p - ofs, -lim_n + ofs);
 
-    // Round away from 0
-    tmp = (value + (value < 0 ? (1<<17)-1 : (1<<17))) >> 18;
-
-    ofs += tmp;  // ofs can to added directly because already recalculated,
-  }
-
-  if (ofs > lim_p)
-    ofs = lim_p;
-  if (ofs < lim_n)
-    ofs = lim_n;
   if (lim->revert)
     ofs = -ofs; // finally do the reverse.
 
   return ofs;
 }
 
+// Limits stage for all the channels at once, using the limits plan
+// (no LimitData decoding) for channels without GVARs
+static void applyChannelsLimits(const int32_t * values)
+{
+  limitsPlanUpdate();
+
+  bitfield_channels_t dynamic = limitsPlan.dynamic;
+  if (isFunctionActive(FUNCTION_TRAINER_CHANNELS) && IS_TRAINER_INPUT_VALID()) {
+    dynamic = (bitfield_channels_t)-1;
+  }
+
+  for (uint8_t ch = 0; ch < MAX_OUTPUT_CHANNELS; ch++) {
+    bitfield_channels_t mask = (bitfield_channels_t)1 << ch;
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+    if ((dynamic & mask) || safetyCh[ch] != OVERRIDE_CHANNEL_UNDEFINED) {
+#else
+    if (dynamic & mask) {
+#endif
+      channelOutputs[ch] = applyLimits(ch, values[ch]);
+      continue;
+    }
+
+    int16_t ofs = applyLimitsScale(applyLimitsCurve(limitsPlan.curve[ch], values[ch]),
+                                   limitsPlan.ofs[ch], limitsPlan.max[ch],
+                                   limitsPlan.min[ch], limitsPlan.gainPos[ch],
+                                   limitsPlan.gainNeg[ch]);
+    channelOutputs[ch] = (limitsPlan.revert & mask) ? -ofs : ofs;
+  }
+}
+
 // TODO same naming convention than the drawSource
 // *valid added to return status to Lua for invalid sources
 getvalue_t getValue(mixsrc_t i, bool* valid)
@@ -448,6 +493,21 @@ getvalue_t getValue(mixsrc_t i, bool* valid)
   }
 }
 
+// Values of the sources read by the mix lines, taken once per mixer pass
+// so that a line only has to do an indexed load instead of getValue()
+static getvalue_t mixerSources[MIXER_SOURCES_COUNT];
+
+static void mixerSourcesUpdate()
+{
+  for (uint8_t w = 0; w < DIM(mixerPlan.sources); w++) {
+    uint32_t bits = mixerPlan.sources[w];
+    for (mixsrc_t src = w * 32; bits; src++, bits >>= 1) {
+      if (bits & 1)
+        mixerSources[src] = getValue(src);
+    }
+  }
+}
+
 void evalTrims()
 {
   uint8_t phase = mixerCurrentFlightMode;
@@ -634,9 +694,14 @@ int getSourceTrimValue(int source, int stickValue=0)
 
 uint8_t mixerCurrentFlightMode;
 
-void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
+// Evaluates the mixer lines of the given channels into chans[] and returns the
+// mix warnings raised. Channels outside the mask keep their current value.
+static uint8_t evalFlightModeChannels(uint8_t mode, uint8_t tick10ms, bitfield_channels_t channels)
 {
+  uint16_t t0 = getTmr2MHz();
   evalInputs(mode);
+  mixerStatsAdd(MIXER_STAGE_INPUTS, t0);
+  t0 = getTmr2MHz();
 
   if (tick10ms)
     evalLogicalSwitches(mode==e_perout_mode_normal);
@@ -705,57 +770,48 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
   }
 #endif
 
-  memclear(chans, sizeof(chans)); // all outputs to 0
-
   //========== MIXER LOOP ===============
   uint8_t lv_mixWarning = 0;
 
+  // after the logical switches and the swash, which are sources too
+  mixerSourcesUpdate();
+
   uint8_t pass = 0;
 
-  bitfield_channels_t dirtyChannels = (bitfield_channels_t)-1; // all dirty when mixer starts
+  bitfield_channels_t dirtyChannels = channels; // all dirty when mixer starts
 
   do {
     bitfield_channels_t passDirtyChannels = 0;
 
-    for (uint8_t i=0; i<MAX_MIXERS; i++) {
+    for (uint8_t opIdx=0; opIdx<mixerPlan.count; opIdx++) {
+      const MixerPlanOp & op = mixerPlan.ops[opIdx];
+      MixData * md = op.md;
+      uint8_t i = op.index;
+
       if (mode == e_perout_mode_normal && pass == 0)
         swOn[i].activeMix = 0;
 
-      MixData * md = mixAddress(i);
-
-      if (md->srcRaw == 0)
-#if defined(COLORLCD)
-        continue;
-#else
-        break;
-#endif
-
-      mixsrc_t stickIndex = md->srcRaw - MIXSRC_Rud;
-
-      if (!(dirtyChannels & ((bitfield_channels_t)1 << md->destCh)))
+      if (!(dirtyChannels & ((bitfield_channels_t)1 << op.destCh)))
         continue;
 
       // if this is the first calculation for the destination channel, initialize it with 0 (otherwise would be random)
-      if (i == 0 || md->destCh != (md-1)->destCh)
-        chans[md->destCh] = 0;
+      if (op.flags & MIXOP_FIRST_OF_CHANNEL)
+        chans[op.destCh] = 0;
 
       //========== FLIGHT MODE && SWITCH =====
-      bool mixCondition = (md->flightModes != 0 || md->swtch);
+      bool mixCondition = (op.flags & MIXOP_CONDITION);
       delayval_t mixEnabled = (!(md->flightModes & (1 << mixerCurrentFlightMode)) && getSwitch(md->swtch)) ? DELAY_POS_MARGIN+1 : 0;
 
 #define MIXER_LINE_DISABLE()   (mixCondition = true, mixEnabled = 0)
 
-      if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER && !IS_TRAINER_INPUT_VALID()) {
+      if (mixEnabled && (op.flags & MIXOP_SRC_TRAINER) && !IS_TRAINER_INPUT_VALID()) {
         MIXER_LINE_DISABLE();
       }
 
 #if defined(LUA_MODEL_SCRIPTS)
       // disable mixer if Lua script is used as source and script was killed
-      if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
-        div_t qr = div(md->srcRaw-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
-        if (scriptInternalData[qr.quot].state != SCRIPT_OK) {
-          MIXER_LINE_DISABLE();
-        }
+      if (mixEnabled && (op.flags & MIXOP_SRC_LUA) && scriptInternalData[op.luaScript].state != SCRIPT_OK) {
+        MIXER_LINE_DISABLE();
       }
 #endif
 
@@ -763,19 +819,22 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
       getvalue_t v = 0;
       if (mode > e_perout_mode_inactive_flight_mode) {
         if (mixEnabled)
-          v = getValue(md->srcRaw);
+          v = mixerSources[op.src];
         else
           continue;
       }
       else {
-        mixsrc_t srcRaw = MIXSRC_Rud + stickIndex;
-        v = getValue(srcRaw);
-        srcRaw -= MIXSRC_CH1;
-        if (srcRaw <= MIXSRC_LAST_CH-MIXSRC_CH1 && md->destCh != srcRaw) {
-          if (dirtyChannels & ((bitfield_channels_t)1 << srcRaw) & (passDirtyChannels|~(((bitfield_channels_t) 1 << md->destCh)-1)))
-            passDirtyChannels |= (bitfield_channels_t) 1 << md->destCh;
-          if (srcRaw < md->destCh || pass > 0)
-            v = chans[srcRaw] >> 8;
+        v = mixerSources[op.src];
+        if (op.srcChannel >= 0 && mixerPlan.ordered) {
+          // source channel already computed in this pass
+          v = chans[op.srcChannel] >> 8;
+        }
+        else if (op.srcChannel >= 0) {
+          uint8_t srcCh = op.srcChannel;
+          if (dirtyChannels & ((bitfield_channels_t)1 << srcCh) & (passDirtyChannels|~(((bitfield_channels_t) 1 << op.destCh)-1)))
+            passDirtyChannels |= (bitfield_channels_t) 1 << op.destCh;
+          if (srcCh < op.destCh || pass > 0)
+            v = chans[srcCh] >> 8;
         }
         if (!mixCondition) {
           mixEnabled = v;
@@ -838,13 +897,16 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
         }
       }
 
-      int32_t weight = GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-      weight = calc100to256_16Bits(weight);
+      int32_t weight = op.weight;
+      if (op.flags & MIXOP_WEIGHT_GVAR) {
+        weight = GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+        weight = calc100to256_16Bits(weight);
+      }
       //========== SPEED ===============
       // now its on input side, but without weight compensation. More like other remote controls
       // lower weight causes slower movement
 
-      if (mode <= e_perout_mode_inactive_flight_mode && (md->speedUp || md->speedDown)) { // there are delay values
+      if (mode <= e_perout_mode_inactive_flight_mode && (op.flags & MIXOP_SLOW)) { // there are delay values
 #define DEL_MULT_SHIFT 8
         // we recale to a mult 256 higher value for calculation
         int32_t tact = act[i];
@@ -892,8 +954,13 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 
       //========== OFFSET / AFTER ===============
       if (applyOffsetAndCurve) {
-        int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-        if (offset) dv += divRoundClosest(calc100toRESX_16Bits(offset), 10) << 8;
+        if (op.flags & MIXOP_OFFSET_GVAR) {
+          int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+          if (offset) dv += divRoundClosest(calc100toRESX_16Bits(offset), 10) << 8;
+        }
+        else {
+          dv += op.offset;
+        }
       }
 
       //========== DIFFERENTIAL =========
@@ -901,13 +968,13 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
         dv = applyCurve(dv, md->curve);
       }
 
-      int32_t * ptr = &chans[md->destCh]; // Save calculating address several times
+      int32_t * ptr = &chans[op.destCh]; // Save calculating address several times
 
       switch (md->mltpx) {
         case MLTPX_REPL:
           *ptr = dv;
           if (mode == e_perout_mode_normal) {
-            for (uint8_t m=i-1; m<MAX_MIXERS && mixAddress(m)->destCh==md->destCh; m--)
+            for (uint8_t m=i-1; m<MAX_MIXERS && mixAddress(m)->destCh==op.destCh; m--)
               swOn[m].activeMix = false;
           }
           break;
@@ -970,7 +1037,18 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 
   } while (++pass < 5 && dirtyChannels);
 
-  mixWarning = lv_mixWarning;
+  mixerStatsAdd(MIXER_STAGE_MIXES, t0);
+
+  return lv_mixWarning;
+}
+
+void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
+{
+  mixerPlanUpdate();
+
+  memclear(chans, sizeof(chans)); // all outputs to 0
+
+  mixWarning = evalFlightModeChannels(mode, tick10ms, (bitfield_channels_t)-1);
 }
 
 
@@ -981,6 +1059,223 @@ uint8_t lastFlightMode = 255; // TODO reinit everything here when the model chan
 tmr10ms_t flightModeTransitionTime;
 uint8_t   flightModeTransitionLast = 255;
 
+static bool isSwitchFlightModeDependent(swsrc_t swtch)
+{
+  swsrc_t idx = abs(swtch);
+  return (idx >= SWSRC_FIRST_LOGICAL_SWITCH && idx <= SWSRC_LAST_LOGICAL_SWITCH) ||
+         (idx >= SWSRC_FIRST_FLIGHT_MODE && idx <= SWSRC_LAST_FLIGHT_MODE);
+}
+
+static bool isSourceFlightModeDependent(mixsrc_t src, uint8_t fm1, uint8_t fm2)
+{
+  if (src >= MIXSRC_FIRST_TRIM && src <= MIXSRC_LAST_TRIM) {
+    uint8_t idx = src - MIXSRC_FIRST_TRIM;
+    return getTrimValue(fm1, idx) != getTrimValue(fm2, idx);
+  }
+#if defined(GVARS)
+  if (src >= MIXSRC_FIRST_GVAR && src <= MIXSRC_LAST_GVAR) {
+    uint8_t gv = src - MIXSRC_FIRST_GVAR;
+    return GVAR_VALUE(gv, getGVarFlightMode(fm1, gv)) != GVAR_VALUE(gv, getGVarFlightMode(fm2, gv));
+  }
+#endif
+  return (src >= MIXSRC_FIRST_LOGICAL_SWITCH && src <= MIXSRC_LAST_LOGICAL_SWITCH) ||
+         (src >= MIXSRC_CYC1 && src <= MIXSRC_CYC3);
+}
+
+static bool isGVarFieldFlightModeDependent(int16_t value, int16_t min, int16_t max, uint8_t fm1, uint8_t fm2)
+{
+  return GET_GVAR_PREC1(value, min, max, fm1) != GET_GVAR_PREC1(value, min, max, fm2);
+}
+
+static bool isCurveFlightModeDependent(const CurveRef & curve, uint8_t fm1, uint8_t fm2)
+{
+  return (curve.type == CURVE_REF_DIFF || curve.type == CURVE_REF_EXPO) &&
+         isGVarFieldFlightModeDependent(curve.value, -100, 100, fm1, fm2);
+}
+
+static bool isTrimFlightModeDependent(int8_t trim, uint8_t fm1, uint8_t fm2)
+{
+  return trim >= 0 && trim < NUM_TRIMS && getTrimValue(fm1, trim) != getTrimValue(fm2, trim);
+}
+
+static bool isExpoFlightModeDependent(const ExpoData * ed, uint8_t fm1, uint8_t fm2)
+{
+  if (((ed->flightModes >> fm1) ^ (ed->flightModes >> fm2)) & 1)
+    return true;
+  if (isSwitchFlightModeDependent(ed->swtch) || isSourceFlightModeDependent(ed->srcRaw, fm1, fm2))
+    return true;
+  if (isGVarFieldFlightModeDependent(ed->weight, -100, 100, fm1, fm2) ||
+      isGVarFieldFlightModeDependent(ed->offset, -100, 100, fm1, fm2) ||
+      isCurveFlightModeDependent(ed->curve, fm1, fm2))
+    return true;
+  if (ed->trimSource < TRIM_ON)
+    return isTrimFlightModeDependent(-ed->trimSource - 1, fm1, fm2);
+  if (ed->trimSource == TRIM_ON && ed->srcRaw >= MIXSRC_Rud && ed->srcRaw <= MIXSRC_Ail)
+    return isTrimFlightModeDependent(ed->srcRaw - MIXSRC_Rud, fm1, fm2);
+  return false;
+}
+
+static bool isMixFlightModeDependent(const MixerPlanOp & op, uint32_t inputs, uint8_t fm1, uint8_t fm2)
+{
+  const MixData * md = op.md;
+  // delays and slow lines keep a state which is only updated by the active flight mode
+  if ((op.flags & MIXOP_SLOW) || md->delayUp || md->delayDown)
+    return true;
+  if (((md->flightModes >> fm1) ^ (md->flightModes >> fm2)) & 1)
+    return true;
+  if (isSwitchFlightModeDependent(md->swtch))
+    return true;
+  if (md->srcRaw >= MIXSRC_FIRST_INPUT && md->srcRaw <= MIXSRC_LAST_INPUT) {
+    if (inputs & ((uint32_t)1 << (md->srcRaw - MIXSRC_FIRST_INPUT)))
+      return true;
+  }
+  else if (isSourceFlightModeDependent(md->srcRaw, fm1, fm2)) {
+    return true;
+  }
+  if ((op.flags & MIXOP_WEIGHT_GVAR) && isGVarFieldFlightModeDependent(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, fm1, fm2))
+    return true;
+  if ((op.flags & MIXOP_OFFSET_GVAR) && isGVarFieldFlightModeDependent(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, fm1, fm2))
+    return true;
+  if (isCurveFlightModeDependent(md->curve, fm1, fm2))
+    return true;
+  // trims of inputs are accounted for in the inputs mask
+  return md->carryTrim == 0 && md->srcRaw >= MIXSRC_Rud && md->srcRaw <= MIXSRC_Ail &&
+         isTrimFlightModeDependent(md->srcRaw - MIXSRC_Rud, fm1, fm2);
+}
+
+// Returns the channels whose output may differ between both flight modes.
+// Conservative: a channel not in the mask is guaranteed to be identical.
+static bitfield_channels_t getFlightModeDiffChannels(uint8_t fm1, uint8_t fm2)
+{
+  static_assert(MAX_INPUTS <= 32, "inputs mask too small");
+  uint32_t inputs = 0;
+  for (uint8_t i=0; i<MAX_EXPOS; i++) {
+    ExpoData * ed = expoAddress(i);
+    if (!EXPO_VALID(ed)) break; // end of list
+    if (isExpoFlightModeDependent(ed, fm1, fm2))
+      inputs |= (uint32_t)1 << ed->chn;
+  }
+
+  // the plan is in dependency order, so source channels are done first
+  bitfield_channels_t channels = 0;
+  for (uint8_t opIdx=0; opIdx<mixerPlan.count; opIdx++) {
+    const MixerPlanOp & op = mixerPlan.ops[opIdx];
+    bitfield_channels_t mask = (bitfield_channels_t)1 << op.destCh;
+    if (channels & mask)
+      continue;
+    if ((op.srcChannel >= 0 && (channels & ((bitfield_channels_t)1 << op.srcChannel))) ||
+        isMixFlightModeDependent(op, inputs, fm1, fm2))
+      channels |= mask;
+  }
+  return channels;
+}
+
+static void sumFlightModeChannels(int32_t * sum_chans512, const int32_t * values, uint16_t weight)
+{
+  for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++)
+    sum_chans512[i] += limit<int32_t>(-0x6fff, values[i] >> 4, 0x6fff) * weight;
+}
+
+// State of the active flight mode, kept while the fading ones are evaluated
+static struct {
+  int32_t chans[MAX_OUTPUT_CHANNELS];
+  int32_t act[MAX_MIXERS];
+  int16_t anas[MAX_INPUTS];
+  int16_t trims[NUM_TRIMS];
+  int8_t  virtualInputsTrims[MAX_INPUTS];
+  int16_t calibratedAnalogs[NUM_CALIBRATED_ANALOGS];
+#if defined(HELI)
+  int16_t cyc_anas[3];
+#endif
+} fadeState;
+
+static void swapSlowMixesState()
+{
+  for (uint8_t opIdx=0; opIdx<mixerPlan.count; opIdx++) {
+    const MixerPlanOp & op = mixerPlan.ops[opIdx];
+    if (op.flags & MIXOP_SLOW) {
+      int32_t tmp = act[op.index];
+      act[op.index] = fadeState.act[op.index];
+      fadeState.act[op.index] = tmp;
+    }
+  }
+}
+
+static void saveFlightModeInputs()
+{
+  memcpy(fadeState.anas, anas, sizeof(anas));
+  memcpy(fadeState.trims, trims, sizeof(trims));
+  memcpy(fadeState.virtualInputsTrims, virtualInputsTrims, sizeof(virtualInputsTrims));
+  memcpy(fadeState.calibratedAnalogs, calibratedAnalogs, sizeof(calibratedAnalogs));
+#if defined(HELI)
+  memcpy(fadeState.cyc_anas, cyc_anas, sizeof(cyc_anas));
+#endif
+}
+
+static void restoreFlightModeInputs()
+{
+  memcpy(anas, fadeState.anas, sizeof(anas));
+  memcpy(trims, fadeState.trims, sizeof(trims));
+  memcpy(virtualInputsTrims, fadeState.virtualInputsTrims, sizeof(virtualInputsTrims));
+  memcpy(calibratedAnalogs, fadeState.calibratedAnalogs, sizeof(calibratedAnalogs));
+#if defined(HELI)
+  memcpy(cyc_anas, fadeState.cyc_anas, sizeof(cyc_anas));
+#endif
+}
+
+// Evaluates the flight modes being faded. The active flight mode is evaluated
+// in full, the others only re-evaluate the channels which depend on the flight
+// mode; the result is the same as evaluating every flight mode in full.
+static int32_t evalFadingFlightModes(uint8_t fm, uint16_t flightModesFade, const uint16_t * fp_act, int32_t * sum_chans512, uint8_t tick10ms)
+{
+  // flight modes evaluated before the active one used to see the slow lines
+  // state before the active flight mode updates it
+  if (flightModesFade & ((1 << fm) - 1)) {
+    for (uint8_t opIdx=0; opIdx<mixerPlan.count; opIdx++) {
+      const MixerPlanOp & op = mixerPlan.ops[opIdx];
+      if (op.flags & MIXOP_SLOW)
+        fadeState.act[op.index] = act[op.index];
+    }
+  }
+
+  mixerCurrentFlightMode = fm;
+  evalFlightModeMixes(e_perout_mode_normal, tick10ms);
+  memcpy(fadeState.chans, chans, sizeof(chans));
+
+  int32_t weight = 0;
+  bool inputsSaved = false;
+  for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
+    if (!(flightModesFade & (0x01 << p)))
+      continue;
+    bitfield_channels_t channels = (p == fm ? 0 : getFlightModeDiffChannels(fm, p));
+    if (channels) {
+      if (!inputsSaved) {
+        saveFlightModeInputs();
+        inputsSaved = true;
+      }
+      memcpy(chans, fadeState.chans, sizeof(chans));
+      if (p < fm)
+        swapSlowMixesState();
+      mixerCurrentFlightMode = p;
+      evalFlightModeChannels(e_perout_mode_inactive_flight_mode, 0, channels);
+      if (p < fm)
+        swapSlowMixesState();
+      sumFlightModeChannels(sum_chans512, chans, fp_act[p]);
+    }
+    else {
+      sumFlightModeChannels(sum_chans512, fadeState.chans, fp_act[p]);
+    }
+    weight += fp_act[p];
+  }
+
+  if (inputsSaved) {
+    restoreFlightModeInputs();
+    memcpy(chans, fadeState.chans, sizeof(chans));
+  }
+
+  return weight;
+}
+
 void evalMixes(uint8_t tick10ms)
 {
   int32_t sum_chans512[MAX_OUTPUT_CHANNELS];
@@ -1028,13 +1323,18 @@ void evalMixes(uint8_t tick10ms)
   int32_t weight = 0;
   if (flightModesFade) {
     memclear(sum_chans512, sizeof(sum_chans512));
-    for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
-      if (flightModesFade & (0x01 << p)) {
-        mixerCurrentFlightMode = p;
-        evalFlightModeMixes(p==fm ? e_perout_mode_normal : e_perout_mode_inactive_flight_mode, p==fm ? tick10ms : 0);
-        for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++)
-          sum_chans512[i] += limit<int32_t>(-0x6fff, chans[i] >> 4, 0x6fff) * fp_act[p];
-        weight += fp_act[p];
+    mixerPlanUpdate();
+    if (mixerPlan.ordered && s_mixer_first_run_done) {
+      weight = evalFadingFlightModes(fm, flightModesFade, fp_act, sum_chans512, tick10ms);
+    }
+    else {
+      for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
+        if (flightModesFade & (0x01 << p)) {
+          mixerCurrentFlightMode = p;
+          evalFlightModeMixes(p==fm ? e_perout_mode_normal : e_perout_mode_inactive_flight_mode, p==fm ? tick10ms : 0);
+          sumFlightModeChannels(sum_chans512, chans, fp_act[p]);
+          weight += fp_act[p];
+        }
       }
     }
     assert(weight);
@@ -1048,6 +1348,7 @@ void evalMixes(uint8_t tick10ms)
   //========== FUNCTIONS ===============
   // must be done after mixing because some functions use the inputs/channels values
   // must be done before limits because of the applyLimit function: it checks for safety switches which would be not initialized otherwise
+  uint16_t t0 = getTmr2MHz();
   if (tick10ms) {
     requiredSpeakerVolume = g_eeGeneral.speakerVolume + VOLUME_LEVEL_DEF;
     requiredBacklightBright = g_eeGeneral.backlightBright;
@@ -1059,23 +1360,30 @@ void evalMixes(uint8_t tick10ms)
     }
     evalFunctions(g_model.customFn, modelFunctionsContext);
   }
+  mixerStatsAdd(MIXER_STAGE_FUNCTIONS, t0);
 
   //========== LIMITS ===============
+  t0 = getTmr2MHz();
   for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++) {
     // chans[i] holds data from mixer.   chans[i] = v*weight => 1024*256
     // later we multiply by the limit (up to 100) and then we need to normalize
     // at the end chans[i] = chans[i]/256 =>  -1024..1024
     // interpolate value with min/max so we get smooth motion from center to stop
     // this limits based on v original values and min=-1024, max=1024  RESX=1024
-    int32_t q = (flightModesFade ? (sum_chans512[i] / weight) << 4 : chans[i]);
-
-    ex_chans[i] = q / 256;
-
-    int16_t value = applyLimits(i, q);  // applyLimits will remove the 256 100% basis
+    // (sum_chans512 is reused to hold the limits stage input)
+    if (flightModesFade) {
+      sum_chans512[i] = (sum_chans512[i] / weight) << 4;
+    } else {
+      sum_chans512[i] = chans[i];
+    }
 
-    channelOutputs[i] = value;  // copy consistent word to int-level
+    ex_chans[i] = sum_chans512[i] / 256;
   }
 
+  // applyLimits will remove the 256 100% basis
+  applyChannelsLimits(sum_chans512);
+  mixerStatsAdd(MIXER_STAGE_LIMITS, t0);
+
   if (tick10ms && flightModesFade) {
     uint16_t tick_delta = delta * tick10ms;
     for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
@@ -0,0 +1,393 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "opentx.h"
+#include "mixer_plan.h"
+#include "switches.h"
+
+MixerPlan mixerPlan;
+LimitsPlan limitsPlan;
+LogicalSwitchesPlan lswPlan;
+
+static bool isGVarField(int16_t value, int16_t min, int16_t max)
+{
+#if defined(GVARS)
+  return GV_IS_GV_VALUE(value, min, max);
+#else
+  return false;
+#endif
+}
+
+// Sort the channels so that each one comes after the channels it uses as
+// source. Returns false (and leaves the ops untouched) if the channels
+// cannot be ordered.
+static bool mixerPlanSort()
+{
+  // static to spare the mixer task stack
+  static bitfield_channels_t deps[MAX_OUTPUT_CHANNELS];
+  static uint8_t runStart[MAX_OUTPUT_CHANNELS];
+  static uint8_t runLength[MAX_OUTPUT_CHANNELS];
+  static uint8_t order[MAX_MIXERS];
+
+  MixerPlan & plan = mixerPlan;
+  bitfield_channels_t remaining = 0;
+
+  memclear(deps, sizeof(deps));
+  memclear(runLength, sizeof(runLength));
+
+  for (uint8_t i = 0; i < plan.count; i++) {
+    const MixerPlanOp & op = plan.ops[i];
+    bool newRun = (i == 0 || (op.flags & MIXOP_FIRST_OF_CHANNEL) ||
+                   op.destCh != plan.ops[i - 1].destCh);
+    bitfield_channels_t mask = (bitfield_channels_t)1 << op.destCh;
+
+    if (newRun) {
+      // lines of one channel split in several places: keep model order
+      if (remaining & mask) return false;
+      remaining |= mask;
+      runStart[op.destCh] = i;
+    }
+
+    runLength[op.destCh]++;
+    if (op.srcChannel >= 0) {
+      deps[op.destCh] |= (bitfield_channels_t)1 << op.srcChannel;
+    }
+  }
+
+  uint8_t count = 0;
+
+  while (remaining) {
+    uint8_t ch = 0;
+    while (ch < MAX_OUTPUT_CHANNELS &&
+           (!(remaining & ((bitfield_channels_t)1 << ch)) ||
+            (deps[ch] & remaining)))
+      ch++;
+
+    if (ch == MAX_OUTPUT_CHANNELS) {
+      // only keep the channels really in a loop, not the ones using them
+      bool pruned;
+      do {
+        pruned = false;
+        for (ch = 0; ch < MAX_OUTPUT_CHANNELS; ch++) {
+          bitfield_channels_t mask = (bitfield_channels_t)1 << ch;
+          if (!(remaining & mask)) continue;
+          bool used = false;
+          for (uint8_t other = 0; other < MAX_OUTPUT_CHANNELS; other++) {
+            if ((remaining & ((bitfield_channels_t)1 << other)) &&
+                (deps[other] & mask)) {
+              used = true;
+              break;
+            }
+          }
+          if (!used) {
+            remaining &= ~mask;
+            pruned = true;
+          }
+        }
+      } while (pruned);
+      plan.loopChannels = remaining;
+      return false;
+    }
+
+    for (uint8_t i = 0; i < runLength[ch]; i++) {
+      order[count++] = runStart[ch] + i;
+    }
+    remaining &= ~((bitfield_channels_t)1 << ch);
+  }
+
+  // apply the permutation in place, to avoid a second copy of the ops
+  // on the mixer task stack
+  for (uint8_t i = 0; i < count; i++) {
+    if (order[i] == i) continue;
+    MixerPlanOp tmp = plan.ops[i];
+    uint8_t j = i;
+    while (order[j] != i) {
+      uint8_t next = order[j];
+      plan.ops[j] = plan.ops[next];
+      order[j] = j;
+      j = next;
+    }
+    plan.ops[j] = tmp;
+    order[j] = j;
+  }
+
+  return true;
+}
+
+static void mixerPlanBuild()
+{
+  uint8_t count = 0;
+
+  memclear(mixerPlan.sources, sizeof(mixerPlan.sources));
+
+  for (uint8_t i = 0; i < MAX_MIXERS; i++) {
+    MixData * md = mixAddress(i);
+
+    if (md->srcRaw == 0)
+#if defined(COLORLCD)
+      continue;
+#else
+      break;
+#endif
+
+    MixerPlanOp & op = mixerPlan.ops[count++];
+    op.md = md;
+    op.src = md->srcRaw < MIXER_SOURCES_COUNT ? md->srcRaw : MIXSRC_NONE;
+    op.index = i;
+    op.destCh = md->destCh;
+    op.flags = 0;
+    op.srcChannel = -1;
+    op.luaScript = 0;
+    op.weight = 0;
+    op.offset = 0;
+
+    if (op.src != MIXSRC_NONE)
+      mixerPlan.sources[op.src / 32] |= (uint32_t)1 << (op.src % 32);
+
+    if (i == 0 || md->destCh != (md - 1)->destCh)
+      op.flags |= MIXOP_FIRST_OF_CHANNEL;
+
+    if (md->flightModes != 0 || md->swtch)
+      op.flags |= MIXOP_CONDITION;
+
+    if (md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER)
+      op.flags |= MIXOP_SRC_TRAINER;
+
+#if defined(LUA_MODEL_SCRIPTS)
+    if (md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
+      op.flags |= MIXOP_SRC_LUA;
+      op.luaScript = (md->srcRaw - MIXSRC_FIRST_LUA) / MAX_SCRIPT_OUTPUTS;
+    }
+#endif
+
+    // a channel using itself as source gets its previous value (ex_chans)
+    if (md->srcRaw >= MIXSRC_CH1 && md->srcRaw <= MIXSRC_LAST_CH &&
+        md->srcRaw - MIXSRC_CH1 != md->destCh) {
+      op.srcChannel = md->srcRaw - MIXSRC_CH1;
+    }
+
+    if (md->speedUp || md->speedDown)
+      op.flags |= MIXOP_SLOW;
+
+    if (isGVarField(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE)) {
+      op.flags |= MIXOP_WEIGHT_GVAR;
+    }
+    else {
+      int32_t weight = GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, 0);
+      op.weight = calc100to256_16Bits(weight);
+    }
+
+    if (isGVarField(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE)) {
+      op.flags |= MIXOP_OFFSET_GVAR;
+    }
+    else {
+      int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, 0);
+      if (offset) op.offset = divRoundClosest(calc100toRESX_16Bits(offset), 10) << 8;
+    }
+  }
+
+  mixerPlan.count = count;
+  mixerPlan.loopChannels = 0;
+  mixerPlan.ordered = mixerPlanSort();
+}
+
+void mixerPlanInvalidate()
+{
+  mixerPlan.valid = false;
+}
+
+void mixerPlanUpdate()
+{
+  if (!mixerPlan.valid) {
+    // flagged first, so that an edit made while building is not lost
+    mixerPlan.valid = true;
+    mixerPlanBuild();
+  }
+}
+
+static void limitsPlanBuild()
+{
+  limitsPlan.revert = 0;
+  limitsPlan.dynamic = 0;
+
+  for (uint8_t ch = 0; ch < MAX_OUTPUT_CHANNELS; ch++) {
+    const LimitData * lim = limitAddress(ch);
+    bitfield_channels_t mask = (bitfield_channels_t)1 << ch;
+
+#if defined(GVARS)
+    if (GV_IS_GV_VALUE(lim->min, -GV_RANGELARGE, GV_RANGELARGE) ||
+        GV_IS_GV_VALUE(lim->max, -GV_RANGELARGE, GV_RANGELARGE) ||
+        GV_IS_GV_VALUE(lim->offset, -LIMIT_STD_MAX, LIMIT_STD_MAX)) {
+      limitsPlan.dynamic |= mask;
+      continue;
+    }
+#endif
+
+    int16_t ofs = LIMIT_OFS_RESX(lim);
+    int16_t lim_p = LIMIT_MAX_RESX(lim);
+    int16_t lim_n = LIMIT_MIN_RESX(lim);
+
+    if (ofs > lim_p) ofs = lim_p;
+    if (ofs < lim_n) ofs = lim_n;
+
+    limitsPlan.ofs[ch] = ofs;
+    limitsPlan.max[ch] = lim_p;
+    limitsPlan.min[ch] = lim_n;
+#if defined(PPM_LIMITS_SYMETRICAL)
+    if (lim->symetrical) {
+      limitsPlan.gainPos[ch] = lim_p;
+      limitsPlan.gainNeg[ch] = -lim_n;
+    }
+    else
+#endif
+    {
+      limitsPlan.gainPos[ch] = lim_p - ofs;
+      limitsPlan.gainNeg[ch] = -lim_n + ofs;
+    }
+    limitsPlan.curve[ch] = lim->curve;
+
+    if (lim->revert) {
+      limitsPlan.revert |= mask;
+    }
+  }
+}
+
+void limitsPlanInvalidate()
+{
+  limitsPlan.valid = false;
+}
+
+void limitsPlanUpdate()
+{
+  if (!limitsPlan.valid) {
+    limitsPlan.valid = true;
+    limitsPlanBuild();
+  }
+}
+
+static uint64_t lswSwitchMask(swsrc_t swtch)
+{
+  swsrc_t idx = abs(swtch);
+  if (idx >= SWSRC_FIRST_LOGICAL_SWITCH && idx <= SWSRC_LAST_LOGICAL_SWITCH)
+    return (uint64_t)1 << (idx - SWSRC_FIRST_LOGICAL_SWITCH);
+  return 0;
+}
+
+static uint64_t lswSourceMask(mixsrc_t src)
+{
+  if (src >= MIXSRC_FIRST_LOGICAL_SWITCH && src <= MIXSRC_LAST_LOGICAL_SWITCH)
+    return (uint64_t)1 << (src - MIXSRC_FIRST_LOGICAL_SWITCH);
+  return 0;
+}
+
+// Logical switches read by the evaluation of the given switch
+static uint64_t logicalSwitchDependencies(uint8_t idx)
+{
+  const LogicalSwitchData * ls = lswAddress(idx);
+
+  if (ls->func == LS_FUNC_NONE)
+    return 0;
+
+  uint64_t deps = lswSwitchMask(ls->andsw);
+
+  switch (lswFamily(ls->func)) {
+    case LS_FAMILY_BOOL:
+      deps |= lswSwitchMask(ls->v1) | lswSwitchMask(ls->v2);
+      break;
+    case LS_FAMILY_COMP:
+      deps |= lswSourceMask(ls->v1) | lswSourceMask(ls->v2);
+      break;
+    case LS_FAMILY_OFS:
+    case LS_FAMILY_DIFF:
+      deps |= lswSourceMask(ls->v1);
+      break;
+    default:
+      // edge, sticky and timers are updated by logicalSwitchesTimerTick()
+      break;
+  }
+
+  return deps;
+}
+
+static bool isLogicalSwitchCombinational(uint8_t idx)
+{
+  const LogicalSwitchData * ls = lswAddress(idx);
+
+  if (lswFamily(ls->func) != LS_FAMILY_BOOL || ls->delay || ls->duration)
+    return false;
+
+  swsrc_t operands[] = { (swsrc_t)ls->v1, (swsrc_t)ls->v2, (swsrc_t)ls->andsw };
+  for (swsrc_t operand: operands) {
+    if (operand != SWSRC_NONE && !lswSwitchMask(operand))
+      return false;
+  }
+
+  // the operands have to be evaluated before it in the same cycle: a
+  // switch reading itself or a later one sees the previous cycle state
+  return !(lswPlan.dependencies[idx] & ~(((uint64_t)1 << idx) - 1));
+}
+
+static void logicalSwitchesPlanBuild()
+{
+  uint8_t count = 0;
+
+  lswPlan.combinational = 0;
+
+  for (uint8_t idx = 0; idx < MAX_LOGICAL_SWITCHES; idx++) {
+    lswPlan.dependencies[idx] = logicalSwitchDependencies(idx);
+    if (lswAddress(idx)->func == LS_FUNC_NONE)
+      continue;
+    lswPlan.order[count++] = idx;
+    if (isLogicalSwitchCombinational(idx))
+      lswPlan.combinational |= (uint64_t)1 << idx;
+  }
+
+  lswPlan.count = count;
+
+  for (uint8_t idx = 0; idx < MAX_LOGICAL_SWITCHES; idx++) {
+    if (lswAddress(idx)->func == LS_FUNC_NONE)
+      lswPlan.order[count++] = idx;
+  }
+}
+
+void logicalSwitchesPlanInvalidate()
+{
+  lswPlan.valid = false;
+}
+
+bool logicalSwitchesPlanUpdate()
+{
+  if (lswPlan.valid)
+    return false;
+
+  lswPlan.valid = true;
+  logicalSwitchesPlanBuild();
+  return true;
+}
+
+void mixerPlansInvalidate()
+{
+  mixerPlanInvalidate();
+  limitsPlanInvalidate();
+  logicalSwitchesPlanInvalidate();
+  curvesLutInvalidate();
+}
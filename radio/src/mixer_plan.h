@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include "dataconstants.h"
+#include "opentx_types.h"
+
+struct MixData;
+
+// The mixer plan is a pre-decoded copy of the model mixer lines: empty
+// slots are dropped and everything that does not change between two mixer
+// runs (source kind, constant weight / offset, multiplex...) is resolved
+// once, when the model is loaded or edited.
+//
+// Channels using other channels as source (CHx) are sorted so that a
+// channel is always computed after the channels it depends on, which lets
+// the mixer evaluate each line exactly once. When the dependencies contain
+// a loop, the lines are kept in model order and the mixer falls back to
+// several passes.
+
+enum MixerPlanOpFlags {
+  MIXOP_FIRST_OF_CHANNEL = (1 << 0), // first line writing into destCh
+  MIXOP_CONDITION        = (1 << 1), // line has flight modes or a switch
+  MIXOP_SRC_TRAINER      = (1 << 2),
+  MIXOP_SRC_LUA          = (1 << 3),
+  MIXOP_WEIGHT_GVAR      = (1 << 4), // weight has to be resolved at runtime
+  MIXOP_OFFSET_GVAR      = (1 << 5), // offset has to be resolved at runtime
+  MIXOP_SLOW             = (1 << 6), // speed up / down defined
+};
+
+// Sources which can be read from the per pass snapshot (see mixerSources)
+#define MIXER_SOURCES_COUNT  (MIXSRC_LAST_TELEM + 1)
+
+struct MixerPlanOp {
+  MixData * md;
+  uint16_t src;        // md->srcRaw, MIXSRC_NONE if out of range
+  uint8_t index;       // mixer line index (swOn[], act[])
+  uint8_t destCh;
+  uint8_t flags;
+  int8_t srcChannel;   // source channel when the source is CHx, -1 otherwise
+  uint8_t luaScript;   // script index when the source is a Lua output
+  int16_t weight;      // weight already scaled to 256 (if constant)
+  int32_t offset;      // offset already scaled to the chans[] range (if constant)
+};
+
+struct MixerPlan {
+  MixerPlanOp ops[MAX_MIXERS];
+  uint8_t count;
+  bool valid;
+  bool ordered;                      // ops are in dependency order
+  bitfield_channels_t loopChannels;  // channels involved in a dependency loop
+  uint32_t sources[(MIXER_SOURCES_COUNT + 31) / 32];  // sources read by the ops
+};
+
+extern MixerPlan mixerPlan;
+
+// Force the plan to be rebuilt on next mixer run
+void mixerPlanInvalidate();
+
+// Rebuild the plan if it has been invalidated since the last build
+void mixerPlanUpdate();
+
+// Drop all the plans below, called when a model is loaded and whenever
+// it is edited (storageDirty(EE_MODEL)). Code changing g_model without
+// going through storageDirty() has to call it.
+void mixerPlansInvalidate();
+
+// Is the channel part of a channel dependency loop (CH1 -> CH2 -> CH1)?
+inline bool mixerPlanChannelInLoop(uint8_t ch)
+{
+  return mixerPlan.loopChannels & ((bitfield_channels_t)1 << ch);
+}
+
+// Output limits of all channels, decoded the same way and laid out as
+// one array per field so that the limits stage runs as a single loop.
+// Channels whose min / max / offset are GVARs are flagged as dynamic
+// and still go through applyLimits().
+struct LimitsPlan {
+  int16_t ofs[MAX_OUTPUT_CHANNELS];      // offset, already within [min, max]
+  int16_t max[MAX_OUTPUT_CHANNELS];
+  int16_t min[MAX_OUTPUT_CHANNELS];
+  int16_t gainPos[MAX_OUTPUT_CHANNELS];  // scale of positive values
+  int16_t gainNeg[MAX_OUTPUT_CHANNELS];  // scale of negative values
+  int8_t curve[MAX_OUTPUT_CHANNELS];
+  bitfield_channels_t revert;
+  bitfield_channels_t dynamic;
+  bool valid;
+};
+
+extern LimitsPlan limitsPlan;
+
+void limitsPlanInvalidate();
+
+// Rebuild the limits plan if it has been invalidated
+void limitsPlanUpdate();
+
+// Logical switches to evaluate, active ones first, in model order: a
+// switch reading a later one sees its state from the previous cycle.
+//
+// Switches made only of earlier logical switches (AND / OR / XOR without
+// delay nor duration) are flagged as combinational: their state cannot
+// change unless one of their operands did, so they can be skipped.
+// Comparison switches read analog sources, they are always evaluated.
+static_assert(MAX_LOGICAL_SWITCHES <= 64, "logical switches masks are 64 bits");
+
+struct LogicalSwitchesPlan {
+  uint8_t order[MAX_LOGICAL_SWITCHES];
+  uint8_t count;           // number of active switches
+  uint64_t combinational;
+  uint64_t dependencies[MAX_LOGICAL_SWITCHES];  // logical switches read
+  bool valid;
+};
+
+extern LogicalSwitchesPlan lswPlan;
+
+void logicalSwitchesPlanInvalidate();
+
+// Rebuild the logical switches plan if it has been invalidated, returns
+// true when the plan was rebuilt
+bool logicalSwitchesPlanUpdate();
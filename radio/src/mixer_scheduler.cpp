@@ -49,18 +49,77 @@ bool mixerSchedulerWaitForTrigger(uint8_t timeoutMs)
 #endif
 }
 
+static uint16_t syncMargin = 0;
+
+void mixerSchedulerSetSyncMargin(uint16_t marginUs)
+{
+  syncMargin = min<uint16_t>(marginUs, MAX_SYNC_MARGIN);
+}
+
+uint16_t mixerSchedulerGetSyncMargin()
+{
+  return syncMargin;
+}
+
+uint16_t mixerSchedulesAdvance(MixerSchedule* schedules, uint8_t count,
+                               uint16_t elapsedUs, int8_t syncModule,
+                               uint8_t& due)
+{
+  int32_t next = INT32_MAX;
+
+  for (uint8_t i = 0; i < count; i++) {
+    auto& sched = schedules[i];
+    if (!sched.period) {
+      // no timing of its own: served on every cycle
+      due |= 1 << i;
+      continue;
+    }
+
+    if (i == syncModule) {
+      sched.remaining = 0;
+    } else {
+      sched.remaining -= elapsedUs;
+    }
+
+    if (sched.remaining <= (int32_t)MIXER_SCHEDULER_MERGE_US) {
+      due |= 1 << i;
+      sched.remaining += sched.period;
+      if (sched.remaining <= 0) {
+        // late by more than a period
+        sched.remaining = sched.period;
+      }
+    }
+
+    if (sched.remaining < next) {
+      next = sched.remaining;
+    }
+  }
+
+  if (next == INT32_MAX) {
+    return 0;
+  }
+
+  return max<int32_t>(next, MIXER_SCHEDULER_MERGE_US);
+}
+
 #if !defined(SIMU)
 
 // Global trigger flag
 
-// Mixer schedule
-struct MixerSchedule {
+static MixerSchedule mixerSchedules[MAX_MODULES];
 
-  // period in us
-  volatile uint16_t period;
-};
+// modules whose frame is due in the current mixer cycle
+static volatile uint8_t dueModules;
 
-static MixerSchedule mixerSchedules[NUM_MODULES];
+static uint16_t getMixerSchedulerDefaultPeriod()
+{
+#if defined(STM32) && !defined(SIMU)
+  if (getSelectedUsbMode() == USB_JOYSTICK_MODE) {
+    return MIXER_SCHEDULER_JOYSTICK_PERIOD_US;
+  }
+#endif
+  return MIXER_SCHEDULER_DEFAULT_PERIOD_US;
+}
 
 uint16_t getMixerSchedulerPeriod()
 {
@@ -74,17 +133,33 @@ uint16_t getMixerSchedulerPeriod()
     return mixerSchedules[EXTERNAL_MODULE].period;
   }
 #endif
-#if defined(STM32) && !defined(SIMU)
-  if (getSelectedUsbMode() == USB_JOYSTICK_MODE) {
-    return MIXER_SCHEDULER_JOYSTICK_PERIOD_US;
-  }
-#endif
-  return MIXER_SCHEDULER_DEFAULT_PERIOD_US;
+  return getMixerSchedulerDefaultPeriod();
 }
 
 void mixerSchedulerInit()
 {
   memset(mixerSchedules, 0, sizeof(mixerSchedules));
+  dueModules = 0;
+}
+
+uint16_t mixerSchedulerNextTrigger(uint16_t elapsedUs, int8_t syncModule)
+{
+  uint8_t due = 0;
+  uint16_t next = mixerSchedulesAdvance(mixerSchedules, MAX_MODULES,
+                                        elapsedUs, syncModule, due);
+  dueModules |= due;
+
+  return next ? next : getMixerSchedulerDefaultPeriod();
+}
+
+uint8_t mixerSchedulerGetDueModules()
+{
+  // the timer ISR may add modules in between
+  __disable_irq();
+  uint8_t due = dueModules;
+  dueModules = 0;
+  __enable_irq();
+  return due;
 }
 
 void mixerSchedulerSetPeriod(uint8_t moduleIdx, uint16_t periodUs)
@@ -96,6 +171,10 @@ void mixerSchedulerSetPeriod(uint8_t moduleIdx, uint16_t periodUs)
     periodUs = MAX_REFRESH_RATE;
   }
 
+  if (!mixerSchedules[moduleIdx].period) {
+    // first frame is due right away
+    mixerSchedules[moduleIdx].remaining = 0;
+  }
   mixerSchedules[moduleIdx].period = periodUs;
 }
 
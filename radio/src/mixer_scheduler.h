@@ -29,6 +29,29 @@
 #define MIN_REFRESH_RATE       850 /* us */
 #define MAX_REFRESH_RATE     50000 /* us */
 
+#define MAX_SYNC_MARGIN       2000 /* us */
+
+// Frames due within this delay are served by the same mixer cycle
+#define MIXER_SCHEDULER_MERGE_US 100u
+
+// Schedule of one module
+struct MixerSchedule {
+
+  // period in us
+  volatile uint16_t period;
+
+  // time left until the next frame is due, in us
+  int32_t remaining;
+};
+
+// Moves each schedule by the time elapsed since the previous call (or
+// re-aligns 'syncModule' on its heartbeat), adds the modules whose frame
+// is due to 'due' and returns the delay until the next one is due in us,
+// 0 if none of them has a period
+uint16_t mixerSchedulesAdvance(MixerSchedule* schedules, uint8_t count,
+                               uint16_t elapsedUs, int8_t syncModule,
+                               uint8_t& due);
+
 #if !defined(SIMU)
 
 // Call once to initialize the mixer scheduler
@@ -61,6 +84,15 @@ uint16_t getMixerSchedulerPeriod();
 // Trigger mixer from an ISR
 void mixerSchedulerISRTrigger();
 
+// Called by the scheduler timer ISR: moves each module schedule by the
+// time elapsed since the previous call (or re-aligns 'syncModule' on
+// its heartbeat) and returns the delay until the next trigger in us
+uint16_t mixerSchedulerNextTrigger(uint16_t elapsedUs, int8_t syncModule);
+
+// Modules whose frame is due in the current mixer cycle (bitmask),
+// to be read by the mixer task before re-enabling the trigger
+uint8_t mixerSchedulerGetDueModules();
+
 #else
 
 #define mixerSchedulerInit()
@@ -76,9 +108,15 @@ void mixerSchedulerISRTrigger();
 
 #define getMixerSchedulerPeriod() (MIXER_SCHEDULER_DEFAULT_PERIOD_US)
 #define mixerSchedulerISRTrigger()
+#define mixerSchedulerGetDueModules() ((uint8_t)((1 << MAX_MODULES) - 1))
 
 #endif
 
+// Safety margin kept between the frame reaching the module
+// and the time the module asked for it (0 = just-in-time)
+void mixerSchedulerSetSyncMargin(uint16_t marginUs);
+uint16_t mixerSchedulerGetSyncMargin();
+
 // Wait for the scheduler timer to trigger
 // returns true if timeout, false otherwise
 bool mixerSchedulerWaitForTrigger(uint8_t timeoutMs);
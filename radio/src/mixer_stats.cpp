@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "opentx.h"
+#include "mixer_stats.h"
+
+const char * const mixerStageNames[MIXER_STAGE_COUNT] = {
+  "adc",
+  "switches",
+  "inputs",
+  "mixes",
+  "functions",
+  "limits",
+  "pulses",
+  "total",
+};
+
+static MixerStageStats mixerStats[MIXER_STAGE_COUNT];
+
+// time spent in each stage during the current cycle, in 0.5us
+static uint32_t mixerStatsCycle[MIXER_STAGE_COUNT];
+
+static volatile bool mixerStatsResetRequested = false;
+
+static uint8_t mixerStatsBucket(uint16_t us)
+{
+  uint8_t bucket = 0;
+  while (us >>= 1) {
+    bucket++;
+  }
+  return bucket < MIXER_STATS_BUCKETS ? bucket : MIXER_STATS_BUCKETS - 1;
+}
+
+void mixerStatsBeginCycle()
+{
+  // drop whatever was measured outside of the mixer task
+  memclear(mixerStatsCycle, sizeof(mixerStatsCycle));
+}
+
+void mixerStatsAdd(uint8_t stage, uint16_t start)
+{
+  mixerStatsCycle[stage] += (uint16_t)(getTmr2MHz() - start);
+}
+
+void mixerStatsEndCycle()
+{
+  if (mixerStatsResetRequested) {
+    memclear(mixerStats, sizeof(mixerStats));
+    mixerStatsResetRequested = false;
+  }
+
+  for (uint8_t stage = 0; stage < MIXER_STAGE_COUNT; stage++) {
+    MixerStageStats & stats = mixerStats[stage];
+    uint16_t us = min<uint32_t>(mixerStatsCycle[stage] / 2, UINT16_MAX);
+    stats.count++;
+    stats.buckets[mixerStatsBucket(us)]++;
+    stats.sum += us;
+    stats.last = us;
+    if (us > stats.max)
+      stats.max = us;
+  }
+}
+
+void mixerStatsReset()
+{
+  mixerStatsResetRequested = true;
+}
+
+const MixerStageStats & mixerStatsGet(uint8_t stage)
+{
+  return mixerStats[stage];
+}
+
+uint16_t mixerStatsAverage(uint8_t stage)
+{
+  const MixerStageStats & stats = mixerStats[stage];
+  return stats.count ? stats.sum / stats.count : 0;
+}
+
+// Returns the upper bound of the bucket holding the given percentile, in us
+uint16_t mixerStatsPercentile(uint8_t stage, uint8_t percent)
+{
+  const MixerStageStats & stats = mixerStats[stage];
+  if (!stats.count)
+    return 0;
+
+  uint32_t threshold = ((uint64_t)stats.count * percent + 99) / 100;
+  uint32_t total = 0;
+  for (uint8_t bucket = 0; bucket < MIXER_STATS_BUCKETS - 1; bucket++) {
+    total += stats.buckets[bucket];
+    if (total >= threshold)
+      return min<uint32_t>((2u << bucket) - 1, stats.max);
+  }
+  return stats.max;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+// Mixer latency statistics: the time spent in each stage of the mixer
+// task is accumulated over a cycle and recorded into a log2 histogram,
+// so that percentiles can be reported from release builds.
+
+enum MixerStage {
+  MIXER_STAGE_ADC,
+  MIXER_STAGE_SWITCHES,
+  MIXER_STAGE_INPUTS,
+  MIXER_STAGE_MIXES,
+  MIXER_STAGE_FUNCTIONS,
+  MIXER_STAGE_LIMITS,
+  MIXER_STAGE_PULSES,
+  MIXER_STAGE_TOTAL,
+  MIXER_STAGE_COUNT
+};
+
+// bucket n counts the cycles with a duration in [2^n, 2^(n+1)) us
+// (bucket 0 includes 0us, the last one includes everything above)
+constexpr uint8_t MIXER_STATS_BUCKETS = 16;
+
+struct MixerStageStats {
+  uint32_t count;
+  uint32_t buckets[MIXER_STATS_BUCKETS];
+  uint64_t sum;  // us
+  uint16_t last; // us
+  uint16_t max;  // us
+};
+
+extern const char * const mixerStageNames[MIXER_STAGE_COUNT];
+
+// mixer task side
+void mixerStatsBeginCycle();
+void mixerStatsAdd(uint8_t stage, uint16_t start); // start = getTmr2MHz() at stage start
+void mixerStatsEndCycle();
+
+// reset is deferred to the end of the current mixer cycle
+void mixerStatsReset();
+
+const MixerStageStats & mixerStatsGet(uint8_t stage);
+uint16_t mixerStatsAverage(uint8_t stage);
+uint16_t mixerStatsPercentile(uint8_t stage, uint8_t percent);
@@ -210,6 +210,26 @@ static void crossfireProcessData(void* ctx, uint8_t data, uint8_t* buffer, uint8
   }
 }
 
+static void crossfireProcessBuffer(void* ctx, const uint8_t* data, uint32_t size,
+                                   uint8_t* buffer, uint8_t* len)
+{
+  while (size > 0) {
+    // once the header is in, the frame body is copied at once; its last
+    // byte goes through crossfireProcessData() which checks the frame
+    if (*len >= 2 && _lenIsSane(buffer[1]) && *len + 1 < buffer[1] + 2) {
+      uint32_t count = min<uint32_t>(buffer[1] + 1 - *len, size);
+      memcpy(buffer + *len, data, count);
+      *len += count;
+      data += count;
+      size -= count;
+      continue;
+    }
+
+    crossfireProcessData(ctx, *data++, buffer, len);
+    size--;
+  }
+}
+
 static const etx_serial_init crsfSerialParams = {
   .baudrate = 0,
   .encoding = ETX_Encoding_8N1,
@@ -257,4 +277,5 @@ const etx_proto_driver_t CrossfireDriver = {
   .deinit = crossfireDeInit,
   .sendPulses = crossfireSendPulses,
   .processData = crossfireProcessData,
+  .processBuffer = crossfireProcessBuffer,
 };
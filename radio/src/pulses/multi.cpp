@@ -283,6 +283,17 @@ static void multiProcessData(void* ctx, uint8_t data, uint8_t* buffer, uint8_t*
   processMultiTelemetryData(data, module);
 }
 
+static void multiProcessBuffer(void* ctx, const uint8_t* data, uint32_t size,
+                               uint8_t* buffer, uint8_t* len)
+{
+  auto mod_st = (etx_module_state_t*)ctx;
+  auto module = modulePortGetModule(mod_st);
+
+  while (size--) {
+    processMultiTelemetryData(*data++, module);
+  }
+}
+
 #include "hal/module_driver.h"
 
 const etx_proto_driver_t MultiDriver = {
@@ -291,6 +302,7 @@ const etx_proto_driver_t MultiDriver = {
   .deinit = multiDeInit,
   .sendPulses = multiSendPulses,
   .processData = multiProcessData,
+  .processBuffer = multiProcessBuffer,
 };
 
 static void sendChannels(uint8_t*& p_buf, uint8_t module)
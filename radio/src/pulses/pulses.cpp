@@ -26,6 +26,7 @@
 #include "heartbeat_driver.h"
 #include "hal/module_port.h"
 #include "tasks/mixer_task.h"
+#include "latency.h"
 
 #include "pulses/pxx2.h"
 #include "pulses/flysky.h"
@@ -382,6 +383,8 @@ static void _init_module(uint8_t module, const etx_proto_driver_t* drv)
   // power ON
   modulePortSetPower(module, true);
   TRACE("Module #%d init succeeded", module);
+
+  latencyAttachModule(module);
 }
 
 static void _deinit_module(uint8_t module)
@@ -552,14 +555,17 @@ void pulsesSendNextFrame(uint8_t module)
     auto drv = mod->drv;
     auto ctx = mod->ctx;
     auto buffer = _module_buffers[module]._buffer;
+    latencyFrameQueued(module, latencyOutputsTimestamp());
     drv->sendPulses(ctx, buffer, channels, nChannels);
   }
 }
 
-void pulsesSendChannels()
+void pulsesSendChannels(uint8_t modules)
 {
   for (uint8_t i = 0; i < MAX_MODULES; i++) {
-    pulsesSendNextFrame(i);
+    if (modules & (1 << i)) {
+      pulsesSendNextFrame(i);
+    }
   }
 }
 
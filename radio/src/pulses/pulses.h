@@ -163,7 +163,9 @@ uint8_t* pulsesGetModuleBuffer(uint8_t module);
 
 void pulsesStopModule(uint8_t module);
 void pulsesSendNextFrame(uint8_t module);
-void pulsesSendChannels();
+
+// Send the next frame on each module in the bitmask
+void pulsesSendChannels(uint8_t modules);
 
 typedef void (*module_init_cb_t)(uint8_t, const etx_proto_driver_t*);
 typedef void (*module_deinit_cb_t)(uint8_t, const etx_proto_driver_t*);
@@ -774,6 +774,28 @@ static void pxx2ProcessData(void* ctx, uint8_t data, uint8_t* buffer, uint8_t* l
   *len = 0;
 }
 
+static void pxx2ProcessBuffer(void* ctx, const uint8_t* data, uint32_t size,
+                              uint8_t* buffer, uint8_t* len)
+{
+  while (size > 0) {
+    // once the header is in, the frame (1 byte start + 1 byte len + 2 bytes
+    // CRC) is copied at once, but for its last byte which goes through
+    // pxx2ProcessData() to check the frame
+    if (*len >= 2 && buffer[1] + 4 <= TELEMETRY_RX_PACKET_SIZE &&
+        *len + 1 < unsigned(buffer[1] + 4)) {
+      uint32_t count = min<uint32_t>(buffer[1] + 3 - *len, size);
+      memcpy(buffer + *len, data, count);
+      *len += count;
+      data += count;
+      size -= count;
+      continue;
+    }
+
+    pxx2ProcessData(ctx, *data++, buffer, len);
+    size--;
+  }
+}
+
 #include "hal/module_driver.h"
 // #include "extmodule_serial_driver.h"
 
@@ -783,4 +805,5 @@ const etx_proto_driver_t Pxx2Driver = {
   .deinit = pxx2DeInit,
   .sendPulses = pxx2SendPulses,
   .processData = pxx2ProcessData,
+  .processBuffer = pxx2ProcessBuffer,
 };
@@ -83,6 +83,7 @@ const char YAMLFILE_CHECKSUM_TAG_NAME[] = "checksum";
 
 #define MODELS_EXT          ".bin"
 #define LOGS_EXT            ".csv"
+#define LOGS_BINARY_EXT     ".bin"
 #define SOUNDS_EXT          ".wav"
 #define BMP_EXT             ".bmp"
 #define PNG_EXT             ".png"
@@ -121,8 +122,20 @@ const char YAMLFILE_CHECKSUM_TAG_NAME[] = "checksum";
 
 extern uint8_t logDelay100ms;
 void logsInit();
+void logsTaskInit();
 void logsClose();
 void logsWrite();
+void logsProcess();
+
+struct LogsStats {
+  uint32_t rows;
+  uint32_t droppedRows;       // rows which did not fit in the queue
+  uint32_t maxQueueDepth;     // bytes
+  uint32_t maxWriteDuration;  // ms
+};
+
+const LogsStats & logsGetStats();
+void logsResetStats();
 
 uint32_t sdGetNoSectors();
 uint32_t sdGetSize();
@@ -134,6 +134,7 @@ void ModelCell::setRfModuleData(uint8_t moduleIdx, ModuleData *modData)
 
 ModelsVector ModelMap::getUnlabeledModels()
 {
+  modelslist.fetchAllModelCells();
   ModelsVector unlabeledModels;
   for (auto model : modelslist) {
     if (modelslabels.getLabelsByModel(model).size() == 0)
@@ -164,6 +165,7 @@ ModelsVector ModelMap::getAllModels()
 
 ModelsVector ModelMap::getModelsByLabel(const std::string &lbl)
 {
+  modelslist.fetchAllModelCells();
   int index = getIndexByLabel(lbl);
   if (index < 0) return ModelsVector();
   ModelsVector rv;
@@ -184,6 +186,7 @@ ModelsVector ModelMap::getModelsByLabel(const std::string &lbl)
 
 ModelsVector ModelMap::getModelsByLabels(const LabelsVector &lbls)
 {
+  modelslist.fetchAllModelCells();
   bool addunlabeled = false;
   // Build a list of the requested indexes
   std::vector<int> idxvect;
@@ -220,6 +223,7 @@ ModelsVector ModelMap::getModelsByLabels(const LabelsVector &lbls)
 ModelsVector ModelMap::getModelsInLabels(const LabelsVector &lbls)
 {
   if (lbls.size() == 0) return ModelsVector();
+  modelslist.fetchAllModelCells();
 
   // Requesting only Unlabeled models
   if (lbls.size() == 1 && lbls.at(0) == STR_UNLABELEDMODEL)
@@ -836,6 +840,10 @@ bool ModelMap::updateModelFile(ModelCell *cell)
 
 void ModelMap::sortModelsBy(ModelsVector &mv, ModelsSortBy sortby)
 {
+  // names are needed for all the models
+  if (sortby == NAME_ASC || sortby == NAME_DES)
+    modelslist.fetchAllModelCells();
+
   if (sortby == DATE_DES) {
     std::sort(mv.begin(), mv.end(), [](ModelCell *a, ModelCell *b) -> bool {
       return a->lastOpened > b->lastOpened;
@@ -877,6 +885,7 @@ ModelsList::~ModelsList() { clear(); }
 void ModelsList::init()
 {
   loaded = false;
+  cellsPending = false;
   currentModel = nullptr;
 }
 
@@ -935,14 +944,18 @@ bool ModelsList::loadTxt()
 
 void ModelMap::updateModelCell(ModelCell *cell)
 {
-  modelslabels.removeModels(cell);
-
   ModelData *model = (ModelData *)malloc(sizeof(ModelData));
   if (!model) {
     TRACE("Labels: Out Of Memory");
+    // Not read: keep its previous data, and drop the hash so that the
+    // model is read again when labels.yml is next loaded
+    cell->modelFinfoHash[0] = '\0';
+    cell->_isDirty = false;
     return;
   }
 
+  modelslabels.removeModels(cell);
+
   TRACE("Labels: Updating model %s", cell->modelFilename);
   readModelYaml(cell->modelFilename, (uint8_t *)model, sizeof(ModelData));
   strncpy(cell->modelName, model->header.name, LEN_MODEL_NAME);
@@ -1025,16 +1038,14 @@ bool ModelsList::loadYaml()
       }
 
       // Store hash & filename
-      filedat cf;
+      filedat &cf = fileHashInfo[finfo.fname];
       FILInfoToHexStr(cf.hash, &finfo);
-      cf.name = finfo.fname;
       cf.celladded = false;
       if (!strncmp(finfo.fname, g_eeGeneral.currModelFilename,
                    LEN_MODEL_FILENAME))
         cf.curmodel = true;
       else
         cf.curmodel = false;
-      fileHashInfo.push_back(cf);
       TRACE_LABELS("File - %s \r\n  HASH - %s - CM: %s", finfo.fname, cf.hash,
                    cf.curmodel ? "Y" : "N");
     }
@@ -1044,18 +1055,20 @@ bool ModelsList::loadYaml()
   // Check if models.yml exists
   // Any files found above that are not listed in the file will be moved into
   // /MDOELS/UNUSED and removed from the discovered file hash list
-  char line[LEN_MODELS_IDX_LINE + 1];
   FILINFO fno;
-  FRESULT result;
   bool foundInModels = f_stat(MODELSLIST_YAML_PATH, &fno) == FR_OK;
   bool foundInRadio = f_stat(FALLBACK_MODELSLIST_YAML_PATH, &fno) == FR_OK;
 
-  if(foundInModels) { // Default to /Models copy
-    result = f_open(&file, MODELSLIST_YAML_PATH, FA_OPEN_EXISTING | FA_READ);
-  } else if (foundInRadio) {
-    result = f_open(&file, FALLBACK_MODELSLIST_YAML_PATH, FA_OPEN_EXISTING | FA_READ);
+  std::vector<std::string> modfiles;
+  const char * error = nullptr;
+  if (foundInModels || foundInRadio) {
+    // Default to /Models copy
+    error = readYamlFile(
+        foundInModels ? MODELSLIST_YAML_PATH : FALLBACK_MODELSLIST_YAML_PATH,
+        get_modelslist_parser_calls(), get_modelslist_iter(&modfiles),
+        nullptr);
   }
-  if((foundInModels || foundInRadio) && result == FR_OK) {
+  if((foundInModels || foundInRadio) && !error) {
     // Create /Models/Unused if it doesn't exist
     bool moveRequired = false;
     DIR unusedFolder;
@@ -1064,44 +1077,26 @@ bool ModelsList::loadYaml()
       if (result == FR_NO_PATH) result = f_mkdir(UNUSED_MODELS_PATH);
       if (result != FR_OK) {
         TRACE("Unable to create unused models folder");
-        f_close(&file);
         return false;
       }
     } else f_closedir(&unusedFolder);
 
-    YamlParser ymp;
-    std::vector<std::string> modfiles;
-    void *ctx = get_modelslist_iter(&modfiles);
-    ymp.init(get_modelslist_parser_calls(), ctx);
-    UINT bytes_read = 0;
-    while (f_read(&file, line, sizeof(line), &bytes_read) == FR_OK) {
-      if (bytes_read == 0) break;
-      if (f_eof(&file)) ymp.set_eof();
-      if (ymp.parse(line, bytes_read) != YamlParser::CONTINUE_PARSING) break;
-    }
-    f_close(&file);
-
     // Loop through file hases, move any files found that don't exists to /unused
-    std::vector<filedat> newFileHash;
-    for(const auto &fhas: fileHashInfo) {
-      bool found = false;
-      for(const auto &file : modfiles) {
-        if (file == fhas.name) {
-          TRACE_LABELS("Found file %s in models.yml.. OK!", file);
-          found = true;
-          break;
-        }
-      }
-      if(!found) {
-        moveRequired = true;
-        TRACE_LABELS("Model %s not in models.yml, moving to /UNUSED", fhas.name.c_str());
-        // Move model into unused folder.
-        const char *warning = sdMoveFile(fhas.name.c_str(), MODELS_PATH, fhas.name.c_str(), UNUSED_MODELS_PATH);
-        if(warning)
-          POPUP_WARNING(warning);
-      } else {
-        newFileHash.push_back(fhas); // File exists, keep it
+    std::set<std::string> listedFiles(modfiles.begin(), modfiles.end());
+    for (auto it = fileHashInfo.begin(); it != fileHashInfo.end();) {
+      const std::string &name = it->first;
+      if (listedFiles.find(name) != listedFiles.end()) {
+        TRACE_LABELS("Found file %s in models.yml.. OK!", name.c_str());
+        ++it; // File exists, keep it
+        continue;
       }
+      moveRequired = true;
+      TRACE_LABELS("Model %s not in models.yml, moving to /UNUSED", name.c_str());
+      // Move model into unused folder.
+      const char *warning = sdMoveFile(name.c_str(), MODELS_PATH, name.c_str(), UNUSED_MODELS_PATH);
+      if(warning)
+        POPUP_WARNING(warning);
+      it = fileHashInfo.erase(it);
     }
 
     if(foundInRadio) {
@@ -1115,7 +1110,6 @@ bool ModelsList::loadYaml()
         POPUP_WARNING(warning);
     }
     if(moveRequired) {
-      fileHashInfo = newFileHash; // Update the new file list
       POPUP_WARNING(TR_MODELS_MOVED "\n" UNUSED_MODELS_PATH, "\n" TR_PRESS_ANY_KEY_TO_SKIP);
     }
   }
@@ -1127,19 +1121,8 @@ bool ModelsList::loadYaml()
 #endif
 
   // Scan labels.yml
-  result = f_open(&file, LABELSLIST_YAML_PATH, FA_OPEN_EXISTING | FA_READ);
-  if (result == FR_OK) {
-    YamlParser yp;
-    void *ctx = get_labelslist_iter();
-    yp.init(get_labelslist_parser_calls(), ctx);
-    UINT bytes_read = 0;
-    while (f_read(&file, line, sizeof(line), &bytes_read) == FR_OK) {
-      if (bytes_read == 0) break;
-      if (f_eof(&file)) yp.set_eof();
-      if (yp.parse(line, bytes_read) != YamlParser::CONTINUE_PARSING) break;
-    }
-    f_close(&file);
-  }
+  readYamlFile(LABELSLIST_YAML_PATH, get_labelslist_parser_calls(),
+               get_labelslist_iter(), nullptr);
 
 #if defined(DEBUG_TIMERS)
   DEBUG_TIMER_SAMPLE(debugTimerYamlScan);
@@ -1150,36 +1133,33 @@ bool ModelsList::loadYaml()
   // Add modelcells for any remaining models that weren't in labels.yml
   for (auto &filehash : fileHashInfo) {
     ModelCell *model = NULL;
-    if (filehash.celladded == false) {
+    if (filehash.second.celladded == false) {
       TRACE_LABELS("  Created a modelcell for %s, not in labels.yml",
-                   filehash.name.c_str());
-      model = new ModelCell(filehash.name.c_str());
-      strncpy(model->modelFinfoHash, filehash.hash, FILE_HASH_LENGTH);
+                   filehash.first.c_str());
+      model = new ModelCell(filehash.first.c_str());
+      strncpy(model->modelFinfoHash, filehash.second.hash, FILE_HASH_LENGTH);
       model->modelFinfoHash[FILE_HASH_LENGTH] = '\0';
       modelslist.push_back(model);
-      filehash.celladded = true;
+      filehash.second.celladded = true;
       model->_isDirty = true;
-      if(filehash.curmodel == true)
+      if(filehash.second.curmodel == true)
         modelslist.setCurrentModel(model);
     }
   }
 
-  // Scan all models, to see if update needed
-  bool updatelabelsyml = false;
+  fileHashInfo.clear();
+
+  // The models marked as dirty are read later, labels.yml is saved
+  // once they are all in sync
   for (auto &model : modelslist) {
-    // Open and read each model if it's marked as dirty
     if (model->_isDirty) {
-      updatelabelsyml = true;
-      modelslabels.updateModelCell(model);
+      cellsPending = true;
+      break;
     }
   }
 
-  fileHashInfo.clear();
-
-  // If any items differed save the file
-  if (updatelabelsyml == true) {
-    TRACE_LABELS("LABELS.YML Wasn't in sync. Needs to be saved");
-    modelslist.save();
+  if (cellsPending) {
+    TRACE_LABELS("LABELS.YML Wasn't in sync. Models will be read");
   } else {
     TRACE_LABELS("LABELS.YML Is in Sync! No models were read");
   }
@@ -1221,7 +1201,9 @@ bool ModelsList::load(Format fmt)
   }
 #endif
 
-  if (!currentModel) {
+  if (currentModel) {
+    fetchModelCell(currentModel);
+  } else {
     TRACE("ERROR no Current Model Found");
     if (modelslist.size()) {
       modelslist.setCurrentModel(modelslist.at(0));
@@ -1282,8 +1264,10 @@ const char *ModelsList::save(LabelsVector newOrder)
     f_puts(model->modelFilename, &file);
     f_puts(":\r\n", &file);
 
+    // not read yet: written again once in sync
     f_puts("    hash: \"", &file);
-    f_puts(model->modelFinfoHash, &file);
+    if (!(cellsPending && model->_isDirty))
+      f_puts(model->modelFinfoHash, &file);
     f_puts("\"\r\n", &file);
 
     f_puts("    name: \"", &file);
@@ -1401,8 +1385,10 @@ ModelCell *ModelsList::addModel(const char *fileName, bool save, ModelCell *copy
 {
   ModelCell *result = new ModelCell(fileName);
   if (copyCell != nullptr) { // Duplicate all data
+    fetchModelCell(copyCell);
     memcpy(result, copyCell, sizeof(ModelCell));
   }
+  result->_isDirty = false;
 
   // Set the new File Name
   strncpy(result->modelFilename, fileName, LEN_MODEL_FILENAME);
@@ -1451,6 +1437,7 @@ bool ModelsList::removeModel(ModelCell *model)
     TRACE("Labels: Unable to move file");
     return true;
   }
+  deleteModelCache(model->modelFilename);
 
   // Free memory
   delete(model);
@@ -1467,6 +1454,50 @@ bool ModelsList::removeModel(ModelCell *model)
  * @return false Success
  */
 
+/**
+ * @brief Reads the model file of a cell not in sync with labels.yml
+ *
+ * @param cell Model to read
+ */
+
+void ModelsList::fetchModelCell(ModelCell *cell)
+{
+  if (cellsPending && cell->_isDirty) {
+    modelslabels.updateModelCell(cell);
+  }
+}
+
+/**
+ * @brief Reads the next model not in sync with labels.yml. labels.yml
+ *        is saved once they are all read.
+ *
+ * @return true A model was read
+ * @return false All the models are in sync
+ */
+
+bool ModelsList::fetchNextModelCell()
+{
+  if (!cellsPending) return false;
+
+  for (auto &model : *this) {
+    if (model->_isDirty) {
+      modelslabels.updateModelCell(model);
+      return true;
+    }
+  }
+
+  TRACE_LABELS("All models read, LABELS.YML needs to be saved");
+  cellsPending = false;
+  modelslabels.setDirty();
+  return false;
+}
+
+void ModelsList::fetchAllModelCells()
+{
+  // Each call reads at most one cell, the last one finds them all in sync
+  for (unsigned i = 0; i <= size() && fetchNextModelCell(); i++);
+}
+
 bool ModelsList::moveModelTo(unsigned curindex, unsigned toindex)
 {
   if (curindex == toindex || curindex >= size() || toindex >= size())
@@ -1496,6 +1527,8 @@ bool ModelsList::moveModelTo(unsigned curindex, unsigned toindex)
 bool ModelsList::isModelIdUnique(uint8_t moduleIdx, char *warn_buf,
                                  size_t warn_buf_len)
 {
+  fetchAllModelCells();
+
   ModelCell *modelCell = modelslist.getCurrentModel();
   if (!modelCell || !modelCell->valid_rfData) {
     // in doubt, pretend it's unique
@@ -1561,6 +1594,8 @@ bool ModelsList::isModelIdUnique(uint8_t moduleIdx, char *warn_buf,
 
 uint8_t ModelsList::findNextUnusedModelId(uint8_t moduleIdx)
 {
+  fetchAllModelCells();
+
   ModelCell *modelCell = modelslist.getCurrentModel();
   if (!modelCell || !modelCell->valid_rfData) {
     return 0;
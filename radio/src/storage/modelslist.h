@@ -215,6 +215,7 @@ class ModelMap : protected std::multimap<uint16_t, ModelCell *>
 class ModelsList : public ModelsVector
 {
   bool loaded;
+  bool cellsPending;
 
   ModelCell *currentModel;
 
@@ -258,13 +259,18 @@ class ModelsList : public ModelsVector
   bool isModelIdUnique(uint8_t moduleIdx, char *warn_buf, size_t warn_buf_len);
   uint8_t findNextUnusedModelId(uint8_t moduleIdx);
 
+  // The models not in sync with labels.yml are only read after load(),
+  // when needed or one at a time by fetchNextModelCell()
+  void fetchModelCell(ModelCell *cell);
+  bool fetchNextModelCell();
+  void fetchAllModelCells();
+
   typedef struct _filedat {
-    std::string name;
     char hash[FILE_HASH_LENGTH + 1];
     bool curmodel = false;
     bool celladded = false;
   } filedat;
-  std::vector<filedat> fileHashInfo;
+  std::map<std::string, filedat> fileHashInfo;  // by file name
 
  protected:
   FIL file;
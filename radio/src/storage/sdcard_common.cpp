@@ -132,7 +132,8 @@ const char* loadModel(char* filename, bool alarms)
 {
   preModelLoad();
 
-  const char* error = readModel(filename, (uint8_t*)&g_model, sizeof(g_model));
+  const char* error = readModel(filename, (uint8_t*)&g_model, sizeof(g_model),
+                                STR_MODELS_PATH, ModelCache::Update);
   if (error) {
     TRACE("loadModel error=%s", error);
 
@@ -55,7 +55,11 @@ const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t*
 
 void getModelPath(char * path, const char * filename, const char* pathName = STR_MODELS_PATH);
 
-const char * readModel(const char * filename, uint8_t * buffer, uint32_t size, const char* pathName = STR_MODELS_PATH);
+// Use of the binary cache of the models files: it is written when a model
+// is loaded for use, the other reads only take it when it is valid
+enum class ModelCache {None, Read, Update};
+
+const char * readModel(const char * filename, uint8_t * buffer, uint32_t size, const char* pathName = STR_MODELS_PATH, ModelCache cache = ModelCache::Read);
 const char * loadModel(char * filename, bool alarms=true);
 const char * loadModelTemplate(const char* fileName, const char* filePath);
 const char * createModel();
@@ -31,6 +31,8 @@
 #include "yaml/yaml_parser.h"
 #include "yaml/yaml_datastructs.h"
 #include "yaml/yaml_bits.h"
+#include "fw_version.h"
+#include "stamp.h"
 
 
 #if defined(EEPROM_RLC)
@@ -38,6 +40,44 @@
  #include "storage/eeprom_rlc.h"
 #endif
 
+// Files are read by whole sectors into a buffer shared by all the YAML
+// reads, like the parser: they are all done from the same task, and
+// never nested (the parser callbacks do not read files)
+#if defined(COLORLCD)
+  #define YAML_READ_BUFFER_SIZE  (4 * 512)
+#else
+  #define YAML_READ_BUFFER_SIZE  512
+#endif
+
+static char yamlReadBuffer[YAML_READ_BUFFER_SIZE] __DMA;
+static YamlParser yamlParser;
+
+// Returns the size of the 'checksum' line at the start of the file, 0 if
+// there is none, -1 if it does not end in the first block
+static int32_t readYamlChecksum(const char* buffer, uint32_t size, uint16_t* file_checksum)
+{
+    const char *skipValue = "checksum: ";
+    const uint32_t skipLen = strlen(skipValue);
+    if (size < skipLen || strncmp(buffer, skipValue, skipLen) != 0)
+      return 0;
+
+    uint32_t pos = skipLen;
+    uint16_t value = 0;
+    while (pos < size && buffer[pos] >= '0' && buffer[pos] <= '9') {
+      value = value * 10 + (buffer[pos++] - '0');
+    }
+
+    // the value and the newline must be in the first block
+    if (pos >= size || (buffer[pos] != '\r' && buffer[pos] != '\n'))
+      return -1;
+    while (pos < size && (buffer[pos] == '\r' || buffer[pos] == '\n')) {
+      pos++;
+    }
+
+    *file_checksum = value;
+    return pos;
+}
+
 const char * readYamlFile(const char* fullpath, const YamlParserCalls* calls, void* parser_ctx, ChecksumResult* checksum_result)
 {
     FIL  file;
@@ -49,45 +89,29 @@ const char * readYamlFile(const char* fullpath, const YamlParserCalls* calls, vo
         return SDCARD_ERROR(result);
     }
 
-    YamlParser yp; //TODO: move to re-usable buffer
+    YamlParser& yp = yamlParser;
     yp.init(calls, parser_ctx);
 
     uint16_t calculated_checksum = 0xFFFF;
     uint16_t file_checksum = 0;
 
     bool first_block = true;
-    char buffer[32];
-    while (f_read(&file, buffer, sizeof(buffer)-1, &bytes_read) == FR_OK) {
+    char* buffer = yamlReadBuffer;
+    while (f_read(&file, buffer, YAML_READ_BUFFER_SIZE, &bytes_read) == FR_OK) {
       if (bytes_read == 0)  // EOF
         break;
       total_bytes += bytes_read;
 
-      uint16_t skip = 0;
+      uint32_t skip = 0;
       if(first_block) {
         // Get the 'checksum' value and skip from further YAML processing
-        // The checksum must be first in the first buffer read from file
         first_block = false;
-        const char *skipValue = "checksum: ";
-        if(strncmp(buffer, skipValue, strlen(skipValue)) == 0) {
-          skip = 10;
-          char* startPos = buffer + strlen(skipValue);
-          char* endPos = startPos;
-          // Advance through the value
-          while((*endPos != '\r') && (*endPos != '\n')) {
-            if (endPos > buffer + bytes_read) {
-              return SDCARD_ERROR(	FR_INT_ERR );
-            }
-            endPos++;
-          }
-          // Skip trailing newline
-          while((*endPos == '\r') || (*endPos == '\n')) {
-            *endPos = 0;
-            endPos++;
-          }
-
-          file_checksum = atoi(startPos);
-          skip = endPos - buffer;
+        int32_t len = readYamlChecksum(buffer, bytes_read, &file_checksum);
+        if (len < 0) {
+          f_close(&file);
+          return SDCARD_ERROR(FR_INT_ERR);
         }
+        skip = len;
       }
 
       // Calculate checksum on read block only if we are called with a pointer to write the resulting checksum
@@ -290,6 +314,78 @@ const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t*
     return NULL;
 }
 
+struct yaml_updater_ctx {
+    FIL*     file;
+    FRESULT  result;
+    uint32_t written;
+};
+
+// Compare the output with the previous content of the file, and only
+// write what differs: the sectors left unchanged are not written again.
+static bool yaml_updater(void* opaque, const char* str, size_t len)
+{
+    yaml_updater_ctx* ctx = (yaml_updater_ctx*)opaque;
+    char buf[32];
+
+    while (len > 0) {
+        UINT count = min<size_t>(len, sizeof(buf));
+        UINT bytes_read = 0;
+        ctx->result = f_read(ctx->file, buf, count, &bytes_read);
+        if (ctx->result != FR_OK)
+            return false;
+
+        if (bytes_read != count || memcmp(buf, str, count) != 0) {
+            UINT bytes_written;
+            ctx->result = f_lseek(ctx->file, f_tell(ctx->file) - bytes_read);
+            if (ctx->result == FR_OK)
+                ctx->result = f_write(ctx->file, str, count, &bytes_written);
+            if ((ctx->result != FR_OK) || (bytes_written != count))
+                return false;
+            ctx->written += count;
+        }
+
+        str += count;
+        len -= count;
+    }
+
+    return true;
+}
+
+// Same as writeFileYaml() without checksum, but the existing file is
+// written in place instead of being created again.
+static const char* updateFileYaml(const char* path, const YamlNode* root_node, uint8_t* data)
+{
+    FIL file;
+
+    if (f_open(&file, path, FA_OPEN_EXISTING | FA_READ | FA_WRITE) != FR_OK) {
+        return writeFileYaml(path, root_node, data, 0);
+    }
+    YamlTreeWalker tree;
+    tree.reset(root_node, data);
+
+    yaml_updater_ctx ctx;
+    ctx.file = &file;
+    ctx.result = FR_OK;
+    ctx.written = 0;
+
+    if (!tree.generate(yaml_updater, &ctx)) {
+        if (ctx.result != FR_OK) {
+            f_close(&file);
+            return SDCARD_ERROR(ctx.result);
+        }
+    }
+
+    // the previous content was longer
+    FRESULT result = FR_OK;
+    if (f_tell(&file) < f_size(&file)) {
+        result = f_truncate(&file);
+    }
+
+    TRACE("%s: %u bytes updated", path, ctx.written);
+    f_close(&file);
+    return result != FR_OK ? SDCARD_ERROR(result) : NULL;
+}
+
 const char * writeGeneralSettings()
 {
     TRACE("YAML radio settings writer");
@@ -315,7 +411,183 @@ const char * writeGeneralSettings()
 }
 
 
-const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t size, const char* pathName)
+//
+// Binary model cache
+//
+// The image of ModelData left by the YAML parser is written next to the
+// model file, and used instead of parsing it on the next loads, as long
+// as the file contents and the firmware are the same
+//
+
+#define MODEL_CACHE_EXT      ".cache"
+#define MODEL_CACHE_MAGIC    "ETXC"
+#define MODEL_CACHE_VERSION  1
+
+PACK(struct ModelCacheHeader {
+  char magic[4];
+  uint8_t version;
+  uint8_t spare[3];
+  uint32_t layoutHash;  // firmware and ModelData layout
+  uint32_t sourceSize;  // YAML file
+  uint32_t sourceHash;
+  uint32_t dataSize;
+  uint32_t dataHash;
+});
+
+// Two CRC16 with different polynomials
+static uint32_t modelCacheHash(const void* data, uint32_t len, uint32_t hash)
+{
+  const uint8_t* p = (const uint8_t*)data;
+  return (uint32_t(crc16(CRC_1021, p, len, hash >> 16)) << 16) |
+         crc16(CRC_1189, p, len, hash & 0xFFFF);
+}
+
+static uint32_t modelCacheHashNode(const YamlNode* node, uint32_t hash)
+{
+  hash = modelCacheHash(&node->type, sizeof(node->type), hash);
+  hash = modelCacheHash(&node->size, sizeof(node->size), hash);
+  if (node->tag) {
+    hash = modelCacheHash(node->tag, node->tag_len, hash);
+  }
+
+  if (node->type == YDT_ARRAY || node->type == YDT_UNION) {
+    if (node->type == YDT_ARRAY) {
+      hash = modelCacheHash(&node->u._array.u._a.elmts, sizeof(node->u._array.u._a.elmts), hash);
+    }
+    for (const YamlNode* child = node->u._array.child; child->type != YDT_NONE; child++) {
+      hash = modelCacheHashNode(child, hash);
+    }
+  }
+  else if (node->type == YDT_ENUM) {
+    for (const YamlIdStr* choice = node->u._enum.choices; choice->str; choice++) {
+      hash = modelCacheHash(&choice->id, sizeof(choice->id), hash);
+      hash = modelCacheHash(choice->str, strlen(choice->str), hash);
+    }
+  }
+  return hash;
+}
+
+// The YAML nodes give the layout of ModelData, but not the numbering of
+// the values written by the custom functions (sources, switches...),
+// hence the firmware version and build time
+static uint32_t modelCacheLayoutHash()
+{
+  static uint32_t layoutHash = 0;
+  if (!layoutHash) {
+    static const char buildStamp[] = DATE " " TIME;
+    const int32_t sizes[] = { (int32_t)sizeof(ModelData), MIXSRC_LAST, SWSRC_LAST };
+    uint32_t hash = modelCacheHash(sizes, sizeof(sizes), 0xFFFFFFFF);
+    hash = modelCacheHash(vers_stamp, strlen(vers_stamp), hash);
+    hash = modelCacheHash(buildStamp, strlen(buildStamp), hash);
+    layoutHash = modelCacheHashNode(get_modeldata_nodes(), hash) | 1;
+  }
+  return layoutHash;
+}
+
+static void getModelCachePath(char* cachePath, const char* path)
+{
+  strcpy(cachePath, path);
+  char* ext = strrchr(cachePath, '.');
+  strcpy(ext ? ext : cachePath + strlen(cachePath), MODEL_CACHE_EXT);
+}
+
+static bool modelCacheExists(const char* path)
+{
+  char cachePath[256];
+  getModelCachePath(cachePath, path);
+
+  FILINFO fno;
+  return f_stat(cachePath, &fno) == FR_OK;
+}
+
+static bool modelCacheSourceHash(const char* path, ModelCacheHeader& header)
+{
+  FIL file;
+  if (f_open(&file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    return false;
+
+  UINT bytes_read;
+  header.sourceSize = 0;
+  header.sourceHash = 0xFFFFFFFF;
+  while (f_read(&file, yamlReadBuffer, YAML_READ_BUFFER_SIZE, &bytes_read) == FR_OK && bytes_read > 0) {
+    header.sourceSize += bytes_read;
+    header.sourceHash = modelCacheHash(yamlReadBuffer, bytes_read, header.sourceHash);
+  }
+
+  bool result = f_eof(&file);
+  f_close(&file);
+  return result;
+}
+
+static bool modelCacheRead(const char* path, const ModelCacheHeader& source, uint8_t* data, uint32_t size)
+{
+  char cachePath[256];
+  getModelCachePath(cachePath, path);
+
+  FIL file;
+  if (f_open(&file, cachePath, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    return false;
+
+  ModelCacheHeader header;
+  UINT bytes_read;
+  bool result =
+      f_read(&file, &header, sizeof(header), &bytes_read) == FR_OK &&
+      bytes_read == sizeof(header) &&
+      !memcmp(header.magic, MODEL_CACHE_MAGIC, sizeof(header.magic)) &&
+      header.version == MODEL_CACHE_VERSION &&
+      header.layoutHash == modelCacheLayoutHash() &&
+      header.sourceSize == source.sourceSize &&
+      header.sourceHash == source.sourceHash && header.dataSize == size &&
+      f_read(&file, data, size, &bytes_read) == FR_OK && bytes_read == size &&
+      header.dataHash == modelCacheHash(data, size, 0xFFFFFFFF);
+
+  f_close(&file);
+  return result;
+}
+
+static void modelCacheWrite(const char* path, ModelCacheHeader& header, const uint8_t* data, uint32_t size)
+{
+  char cachePath[256];
+  getModelCachePath(cachePath, path);
+
+  memcpy(header.magic, MODEL_CACHE_MAGIC, sizeof(header.magic));
+  header.version = MODEL_CACHE_VERSION;
+  memclear(header.spare, sizeof(header.spare));
+  header.layoutHash = modelCacheLayoutHash();
+  header.dataSize = size;
+  header.dataHash = modelCacheHash(data, size, 0xFFFFFFFF);
+
+  FIL file;
+  if (f_open(&file, cachePath, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+    return;
+
+  UINT written;
+  bool result =
+      f_write(&file, &header, sizeof(header), &written) == FR_OK &&
+      written == sizeof(header) &&
+      f_write(&file, data, size, &written) == FR_OK && written == size;
+
+  f_close(&file);
+  if (!result) {
+    f_unlink(cachePath);
+  }
+}
+
+static void modelCacheDelete(const char* path)
+{
+  char cachePath[256];
+  getModelCachePath(cachePath, path);
+  f_unlink(cachePath);
+}
+
+void deleteModelCache(const char* filename)
+{
+  char path[256];
+  getModelPath(path, filename);
+  modelCacheDelete(path);
+}
+
+const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t size, const char* pathName, ModelCache cache)
 {
     // YAML reader
     TRACE("YAML model reader");
@@ -337,6 +609,18 @@ const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t siz
     char path[256];
     getModelPath(path, filename, pathName);
 
+    // only the models themselves are cached, not the templates. A plain
+    // read only hashes the source when there is a cache to compare with.
+    ModelCacheHeader header;
+    bool cached = cache != ModelCache::None && init_model &&
+                  !strcmp(pathName, STR_MODELS_PATH) &&
+                  (cache == ModelCache::Update || modelCacheExists(path)) &&
+                  modelCacheSourceHash(path, header);
+    if (cached && modelCacheRead(path, header, buffer, size)) {
+      TRACE("YAML model read from cache");
+      return nullptr;
+    }
+
     YamlTreeWalker tree;
     tree.reset(data_nodes, buffer);
 
@@ -364,19 +648,23 @@ const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t siz
       md->rfAlarms.critical = 42;
     }
 
-    return readYamlFile(path, YamlTreeWalker::get_parser_calls(), &tree, NULL);
+    const char* error = readYamlFile(path, YamlTreeWalker::get_parser_calls(), &tree, NULL);
+    if (!error && cached && cache == ModelCache::Update) {
+      modelCacheWrite(path, header, buffer, size);
+    }
+    return error;
 }
 
 static const char _wrongExtentionError[] = "wrong file extension";
 
-const char* readModel(const char* filename, uint8_t* buffer, uint32_t size, const char* pathName)
+const char* readModel(const char* filename, uint8_t* buffer, uint32_t size, const char* pathName, ModelCache cache)
 {
   const char* ext = strrchr(filename, '.');
   if (!ext || strncmp(ext, YAML_EXT, 4) != 0) {
     return _wrongExtentionError;
   }
 
-  return readModelYaml(filename, buffer, size, pathName);
+  return readModelYaml(filename, buffer, size, pathName, cache);
 }
 
 const char * writeModelYaml(const char* filename)
@@ -384,7 +672,9 @@ const char * writeModelYaml(const char* filename)
     TRACE("YAML model writer");
     char path[256];
     getModelPath(path, filename);
-    return writeFileYaml(path, get_modeldata_nodes(), (uint8_t*)&g_model,0 );
+    // the cache is written again when the model is next loaded
+    modelCacheDelete(path);
+    return updateFileYaml(path, get_modeldata_nodes(), (uint8_t*)&g_model);
 }
 
 #if !defined(STORAGE_MODELSLIST)
@@ -522,6 +812,7 @@ int8_t deleteModel(uint8_t idx)
   if (f_unlink(fname) != FR_OK) {
     return -1;
   }
+  modelCacheDelete(fname);
 
   modelHeaders[idx].name[0] = '\0';
   return 0;
@@ -26,9 +26,13 @@ enum class ChecksumResult {Success, Failed, None};
 
 constexpr uint8_t MODELIDX_STRLEN = sizeof(MODEL_FILENAME_PREFIX "00");
 
+struct YamlParserCalls;
+
+const char * readYamlFile(const char* fullpath, const YamlParserCalls* calls, void* parser_ctx, ChecksumResult* checksum_result);
 const char * loadRadioSettingsYaml(bool checks);
 const char * writeModelYaml(const char* filename);
-const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t size, const char* pathName = STR_MODELS_PATH);
+const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t size, const char* pathName = STR_MODELS_PATH, ModelCache cache = ModelCache::Read);
+void deleteModelCache(const char* filename);
 bool YamlFileChecksum(const YamlNode* root_node, uint8_t* data, uint16_t* checksum);
 
 void getModelNumberStr(uint8_t idx, char* model_idx);
@@ -20,6 +20,7 @@
  */
 
 #include "opentx.h"
+#include "mixer_plan.h"
 #include "timers_driver.h"
 #include "tasks/mixer_task.h"
 
@@ -47,6 +48,11 @@ void storageDirty(uint8_t msk)
   storageDirtyMsk |= msk;
   storageDirtyTime10ms = get_tmr10ms();
 
+  if (msk & EE_MODEL) {
+    mixerPlansInvalidate();
+    telemetrySensorsInvalidate();
+  }
+
 #if defined(RTC_BACKUP_RAM)
   rambackupDirtyMsk = storageDirtyMsk;
   rambackupDirtyTime10ms = storageDirtyTime10ms;
@@ -190,6 +196,8 @@ void postModelLoad(bool alarms)
 
   loadCurves();
   sortMixerLines();
+  mixerPlansInvalidate();
+  telemetrySensorsInvalidate();
 
 #if defined(GUI)
   if (alarms) {
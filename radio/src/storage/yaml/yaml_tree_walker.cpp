@@ -45,8 +45,9 @@ uint32_t yaml_parse_enum(const struct YamlIdStr* choices, const char* val, uint8
     while (choices->str) {
 
         // we have a match!
-        if( strncmp(val, choices->str, val_len) == 0
-          && strlen(choices->str) == val_len)
+        if (val_len > 0 && choices->str[0] == val[0]
+            && strncmp(val, choices->str, val_len) == 0
+            && choices->str[val_len] == '\0')
             break;
 
         choices++;
@@ -253,22 +254,13 @@ void YamlTreeWalker::rewind()
 // the current collection (node of type YDT_NONE) is reached.
 //
 // return true if a match has been found.
-bool YamlTreeWalker::findNode(const char* tag, uint8_t tag_len)
+bool YamlTreeWalker::findNextNode(const char* tag, uint8_t tag_len)
 {
-    if (virt_level)
-        return false;
-
-    rewind();
-
     const struct YamlNode* attr = getAttr();
-    if (isArrayElmt() && attr && attr->type == YDT_IDX) {
-        setAttrValue((char*)tag, tag_len);
-        return true;
-    }
-
     while(attr && attr->type != YDT_NONE) {
 
         if ((tag_len == attr->tag_len)
+            && (tag_len == 0 || tag[0] == attr->tag[0])
             && !strncmp(tag, attr->tag, tag_len)) {
             return true; // attribute found!
         }
@@ -280,6 +272,35 @@ bool YamlTreeWalker::findNode(const char* tag, uint8_t tag_len)
     return false;
 }
 
+// The attributes are written in the order of the nodes, so the search
+// starts from the last attribute found, and only starts again from the
+// first one when the file has them in another order.
+//
+// return true if a match has been found.
+bool YamlTreeWalker::findNode(const char* tag, uint8_t tag_len)
+{
+    if (virt_level)
+        return false;
+
+    const YamlNode* node = getNode();
+    bool idx_elmt = isArrayElmt()
+        && (node->type == YDT_ARRAY || node->type == YDT_UNION)
+        && node->u._array.child->type == YDT_IDX;
+
+    if (!idx_elmt && findNextNode(tag, tag_len))
+        return true;
+
+    rewind();
+
+    const struct YamlNode* attr = getAttr();
+    if (isArrayElmt() && attr && attr->type == YDT_IDX) {
+        setAttrValue((char*)tag, tag_len);
+        return true;
+    }
+
+    return findNextNode(tag, tag_len);
+}
+
 // Get the current bit offset
 unsigned int YamlTreeWalker::getBitOffset()
 {
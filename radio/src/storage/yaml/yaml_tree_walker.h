@@ -111,6 +111,10 @@ class YamlTreeWalker
     // (and reset the bit offset)
     void rewind();
 
+    // Increment the cursor until a match is found or the end of
+    // the current collection (node of type YDT_NONE) is reached.
+    bool findNextNode(const char* tag, uint8_t tag_len);
+
 public:
     YamlTreeWalker();
 
@@ -139,8 +143,8 @@ public:
         return stack[stack_level + lvl].elmts;
     }
 
-    // Increment the cursor until a match is found or the end of
-    // the current collection (node of type YDT_NONE) is reached.
+    // Search the current collection for the given tag, starting
+    // from the cursor, then from the first attribute.
     //
     // return true if a match has been found.
     bool findNode(const char* tag, uint8_t tag_len);
@@ -21,6 +21,7 @@
 
 #include "opentx.h"
 #include "switches.h"
+#include "mixer_plan.h"
 
 #include "tasks/mixer_task.h"
 
@@ -44,17 +45,21 @@ enum LogicalSwitchContextState {
 };
 
 PACK(struct LogicalSwitchContext {
-  uint8_t state:1;
   uint8_t timerState:2;
-  uint8_t spare:5;
+  uint8_t spare:6;
   uint8_t timer;
   int16_t lastValue;
 });
 
-PACK(struct LogicalSwitchesFlightModeContext {
+struct LogicalSwitchesFlightModeContext {
+  uint64_t states;  // one bit per logical switch
   LogicalSwitchContext lsw[MAX_LOGICAL_SWITCHES];
-});
+};
 LogicalSwitchesFlightModeContext lswFm[MAX_FLIGHT_MODES];
+
+// Flight modes whose logical switches have to be fully evaluated
+#define LSW_FULL_EVAL_ALL  ((1 << MAX_FLIGHT_MODES) - 1)
+static uint16_t lswFullEval = LSW_FULL_EVAL_ALL;
 CircularBuffer<uint8_t, 8> luaSetStickySwitchBuffer;
 
 #define LS_LAST_VALUE(fm, idx) lswFm[fm].lsw[idx].lastValue
@@ -621,7 +626,7 @@ bool getSwitch(swsrc_t swtch, uint8_t flags)
    }
   else {
     cs_idx -= SWSRC_FIRST_LOGICAL_SWITCH;
-    result = lswFm[mixerCurrentFlightMode].lsw[cs_idx].state;
+    result = (lswFm[mixerCurrentFlightMode].states >> cs_idx) & 1;
   }
 
   return swtch > 0 ? result : !result;
@@ -632,19 +637,42 @@ bool getSwitch(swsrc_t swtch, uint8_t flags)
 */
 void evalLogicalSwitches(bool isCurrentFlightmode)
 {
-  for (unsigned int idx=0; idx<MAX_LOGICAL_SWITCHES; idx++) {
-    LogicalSwitchContext & context = lswFm[mixerCurrentFlightMode].lsw[idx];
+  if (logicalSwitchesPlanUpdate())
+    lswFullEval = LSW_FULL_EVAL_ALL;
+
+  // all switches are evaluated after the model or the states have changed,
+  // only the active ones afterwards
+  uint16_t fmMask = 1 << mixerCurrentFlightMode;
+  bool fullEval = lswFullEval & fmMask;
+  uint8_t count = fullEval ? MAX_LOGICAL_SWITCHES : lswPlan.count;
+  uint64_t changed = 0;
+
+  for (uint8_t n=0; n<count; n++) {
+    uint8_t idx = lswPlan.order[n];
+    uint64_t mask = (uint64_t)1 << idx;
+
+    if (!fullEval && (lswPlan.combinational & mask) &&
+        !(lswPlan.dependencies[idx] & changed))
+      continue;
+
+    LogicalSwitchesFlightModeContext & context = lswFm[mixerCurrentFlightMode];
+    bool state = context.states & mask;
     bool result = getLogicalSwitch(idx);
     if (isCurrentFlightmode) {
       if (result) {
-        if (!context.state) PLAY_LOGICAL_SWITCH_ON(idx);
+        if (!state) PLAY_LOGICAL_SWITCH_ON(idx);
       }
       else {
-        if (context.state) PLAY_LOGICAL_SWITCH_OFF(idx);
+        if (state) PLAY_LOGICAL_SWITCH_OFF(idx);
       }
     }
-    context.state = result;
+    if (result != state) {
+      changed |= mask;
+      context.states ^= mask;
+    }
   }
+
+  lswFullEval &= ~fmMask;
 }
 
 swarnstate_t switches_states = 0;
@@ -1022,6 +1050,7 @@ void logicalSwitchesReset()
   }
 
   luaSetStickySwitchBuffer.clear();
+  lswFullEval = LSW_FULL_EVAL_ALL;
 }
 
 getvalue_t convertLswTelemValue(LogicalSwitchData * ls)
@@ -26,6 +26,9 @@
 
 #include "FreeRTOSConfig.h"
 
+// time elapsed when the heartbeat triggered the mixer (0 = timer trigger)
+static volatile uint16_t softTriggerElapsed;
+
 // Start scheduler with default period
 void mixerSchedulerStart()
 {
@@ -35,6 +38,7 @@ void mixerSchedulerStart()
   MIXER_SCHEDULER_TIMER->CCMR1 = 0;
   MIXER_SCHEDULER_TIMER->ARR   = getMixerSchedulerPeriod() - 1;
   MIXER_SCHEDULER_TIMER->CNT   = 0;   // reset counter
+  softTriggerElapsed = 0;
 
   NVIC_EnableIRQ(MIXER_SCHEDULER_TIMER_IRQn);
   NVIC_SetPriority(MIXER_SCHEDULER_TIMER_IRQn,
@@ -67,6 +71,7 @@ void mixerSchedulerSoftTrigger() {
   // - fires MIXER_SCHEDULER_TIMER interrupt after returning from this ISR
   // - MIXER_SCHEDULER_TIMER_IRQHandler(void) takes care of making FreeRTOS calls
   //   to ensure switching to highest priority task.
+  softTriggerElapsed = MIXER_SCHEDULER_TIMER->CNT + 1;
   MIXER_SCHEDULER_TIMER->EGR = TIM_EGR_UG; 
 }
 
@@ -75,8 +80,18 @@ extern "C" void MIXER_SCHEDULER_TIMER_IRQHandler(void)
   MIXER_SCHEDULER_TIMER->SR &= ~TIM_SR_UIF; // clear flag
   mixerSchedulerDisableTrigger();
 
+  // the heartbeat is only used by the internal module
+  uint16_t elapsed = softTriggerElapsed;
+  int8_t syncModule = -1;
+  if (elapsed) {
+    softTriggerElapsed = 0;
+    syncModule = INTERNAL_MODULE;
+  } else {
+    elapsed = MIXER_SCHEDULER_TIMER->ARR + 1;
+  }
+
   // set next period
-  MIXER_SCHEDULER_TIMER->ARR = getMixerSchedulerPeriod() - 1;
+  MIXER_SCHEDULER_TIMER->ARR = mixerSchedulerNextTrigger(elapsed, syncModule) - 1;
 
   // trigger mixer start
   mixerSchedulerISRTrigger();
@@ -310,6 +310,7 @@ static void stm32_serial_send_buffer(void* ctx, const uint8_t* data, uint32_t si
   auto usart = sp->usart;
   if (usart->txDMA && !IS_CCM_RAM(data)) {
     stm32_usart_send_buffer(usart, data, size);
+    if (st->callbacks.on_tx_complete) stm32_usart_enable_tc_irq(usart);
     return;
   }
 
@@ -353,6 +354,19 @@ static void stm32_enable_rx(void* ctx)
   stm32_usart_enable_rx(st->sp->usart);
 }
 
+// Current write index in the RX buffer (from DMA or IRQ)
+static uint32_t stm32_serial_rx_widx(stm32_serial_state* st)
+{
+  auto usart = st->sp->usart;
+  if (LL_USART_IsEnabledDMAReq_RX(usart->USARTx)) {
+    auto dma = usart->rxDMA;
+    auto stream = usart->rxDMA_Stream;
+    return st->sp->rx_buffer.length - LL_DMA_GetDataLength(dma, stream);
+  } else {
+    return st->rx_buf.widx;
+  }
+}
+
 static int stm32_serial_get_byte(void* ctx, uint8_t* data)
 {
   auto st = (stm32_serial_state*)ctx;
@@ -366,16 +380,7 @@ static int stm32_serial_get_byte(void* ctx, uint8_t* data)
   auto buf = rx_buf.buffer;
   auto& buf_st = st->rx_buf;
 
-  uint32_t widx;
-  auto usart = sp->usart;
-  if (LL_USART_IsEnabledDMAReq_RX(usart->USARTx)) {
-    auto dma = usart->rxDMA;
-    auto stream = usart->rxDMA_Stream;
-    widx = buf_len - LL_DMA_GetDataLength(dma, stream);
-  } else {
-    widx = buf_st.widx;
-  }
-
+  uint32_t widx = stm32_serial_rx_widx(st);
   if (buf_st.ridx == widx)
     return 0;
 
@@ -385,6 +390,37 @@ static int stm32_serial_get_byte(void* ctx, uint8_t* data)
   return 1;
 }
 
+static int stm32_serial_get_rx_span(void* ctx, const uint8_t** data)
+{
+  auto st = (stm32_serial_state*)ctx;
+  if (!st) return -1;
+
+  auto sp = st->sp;
+  const auto& rx_buf = sp->rx_buffer;
+  auto buf_len = rx_buf.length;
+  if (!buf_len) return -1;
+
+  uint32_t widx = stm32_serial_rx_widx(st);
+  uint32_t ridx = st->rx_buf.ridx;
+
+  // the block ends at the write index or at the end of the buffer,
+  // the rest is returned by the next call
+  *data = rx_buf.buffer + ridx;
+  return (widx >= ridx ? widx : buf_len) - ridx;
+}
+
+static void stm32_serial_skip_rx_bytes(void* ctx, uint32_t len)
+{
+  auto st = (stm32_serial_state*)ctx;
+  if (!st) return;
+
+  auto buf_len = st->sp->rx_buffer.length;
+  if (!buf_len) return;
+
+  auto& buf_st = st->rx_buf;
+  buf_st.ridx = (buf_st.ridx + len) & (buf_len - 1);
+}
+
 static int stm32_serial_get_last_byte(void* ctx, uint32_t idx, uint8_t* data)
 {
   auto st = (stm32_serial_state*)ctx;
@@ -396,17 +432,7 @@ static int stm32_serial_get_last_byte(void* ctx, uint32_t idx, uint8_t* data)
   if (!buf_len) return -1;
   
   auto buf = rx_buf.buffer;
-  auto& buf_st = st->rx_buf;
-
-  uint32_t widx;
-  auto usart = sp->usart;
-  if (LL_USART_IsEnabledDMAReq_RX(usart->USARTx)) {
-    auto dma = usart->rxDMA;
-    auto stream = usart->rxDMA_Stream;
-    widx = buf_len - LL_DMA_GetDataLength(dma, stream);
-  } else {
-    widx = buf_st.widx;
-  }
+  uint32_t widx = stm32_serial_rx_widx(st);
 
   // Please note that we do not check the read cursor
   // so that this function might return data that
@@ -476,6 +502,14 @@ static void stm32_serial_set_idle_cb(void* ctx, void (*on_idle)())
   stm32_usart_set_idle_irq(st->sp->usart, enabled);
 }
 
+static void stm32_serial_set_tx_complete_cb(void* ctx, void (*on_tx_complete)())
+{
+  auto st = (stm32_serial_state*)ctx;
+  if (!st) return;
+
+  st->callbacks.on_tx_complete = on_tx_complete;
+}
+
 const etx_serial_driver_t STM32SerialDriver = {
   .init = stm32_serial_init,
   .deinit = stm32_serial_deinit,
@@ -485,6 +519,8 @@ const etx_serial_driver_t STM32SerialDriver = {
   .waitForTxCompleted = stm32_wait_tx_completed,
   .enableRx = stm32_enable_rx,
   .getByte = stm32_serial_get_byte,
+  .getRxSpan = stm32_serial_get_rx_span,
+  .skipRxBytes = stm32_serial_skip_rx_bytes,
   .getLastByte = stm32_serial_get_last_byte,
   .clearRxBuffer = stm32_serial_clear_rx_buffer,
   .getBaudrate = stm32_serial_get_baudrate,
@@ -494,4 +530,5 @@ const etx_serial_driver_t STM32SerialDriver = {
   .setReceiveCb = nullptr, // TODO
   .setIdleCb = stm32_serial_set_idle_cb,
   .setBaudrateCb = nullptr,
+  .setTxCompleteCb = stm32_serial_set_tx_complete_cb,
 };
@@ -514,4 +514,5 @@ const etx_serial_driver_t STM32SoftSerialTxDriver = {
   .setReceiveCb = nullptr,
   .setIdleCb = nullptr,
   .setBaudrateCb = nullptr,
+  .setTxCompleteCb = nullptr,
 };
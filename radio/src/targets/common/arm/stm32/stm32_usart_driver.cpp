@@ -375,6 +375,20 @@ void stm32_usart_send_buffer(const stm32_usart_t* usart, const uint8_t * data, u
   }
 }
 
+void stm32_usart_enable_tc_irq(const stm32_usart_t* usart)
+{
+  if ((int32_t)(usart->IRQn) < 0) return;
+
+  // TC is raised only once DMA stops feeding the USART
+  LL_USART_ClearFlag_TC(usart->USARTx);
+  LL_USART_EnableIT_TC(usart->USARTx);
+
+  // the ISR is disabled on RX + TX DMA ports without IDLE IRQ
+  if (!NVIC_GetEnableIRQ(usart->IRQn)) {
+    _enable_usart_irq(usart);
+  }
+}
+
 uint8_t stm32_usart_tx_completed(const stm32_usart_t* usart)
 {
   if (LL_USART_IsEnabledDMAReq_TX(usart->USARTx)) {
@@ -535,20 +549,25 @@ void stm32_usart_isr(const stm32_usart_t* usart, etx_serial_callbacks_t* cb)
   uint32_t idle = (status & LL_USART_SR_IDLE);
   uint32_t txe = (status & LL_USART_SR_TXE);
 
-  // TC is only enabled with 2-wire half-duplex when TX DMA was in use
+  // TC is only enabled with 2-wire half-duplex when TX DMA was in use,
+  // or when the end of transmission has to be notified
   if (LL_USART_IsEnabledIT_TC(usart->USARTx) && (status & LL_USART_SR_TC)) {
 
     // disable TC IRQ
     LL_USART_DisableIT_TC(usart->USARTx);
 
-    // switch to input
-    _half_duplex_input(usart);
+    if (usart->set_input) {
+      // switch to input
+      _half_duplex_input(usart);
 
-    // and drain RX side first
-    while (status & LL_USART_SR_RXNE) {
-      status = LL_USART_ReadReg(usart->USARTx, DR);
-      status = LL_USART_ReadReg(usart->USARTx, SR);
+      // and drain RX side first
+      while (status & LL_USART_SR_RXNE) {
+        status = LL_USART_ReadReg(usart->USARTx, DR);
+        status = LL_USART_ReadReg(usart->USARTx, SR);
+      }
     }
+
+    if (cb->on_tx_complete) cb->on_tx_complete();
   }
   
   // Receive: do it first as it is more time critical
@@ -582,6 +601,8 @@ void stm32_usart_isr(const stm32_usart_t* usart, etx_serial_callbacks_t* cb)
       LL_USART_TransmitData8(usart->USARTx, data);
     } else {
       LL_USART_DisableIT_TXE(usart->USARTx);
+      // TC will be raised once the last byte has left the shift register
+      if (cb->on_tx_complete) LL_USART_EnableIT_TC(usart->USARTx);
     }
   }
 
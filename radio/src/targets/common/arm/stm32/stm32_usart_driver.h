@@ -62,6 +62,7 @@ void stm32_usart_deinit(const stm32_usart_t* usart);
 void stm32_usart_deinit_rx_dma(const stm32_usart_t* usart);
 void stm32_usart_send_byte(const stm32_usart_t* usart, uint8_t byte);
 void stm32_usart_send_buffer(const stm32_usart_t* usart, const uint8_t * data, uint32_t size);
+void stm32_usart_enable_tc_irq(const stm32_usart_t* usart);
 uint8_t stm32_usart_tx_completed(const stm32_usart_t* usart);
 void stm32_usart_wait_for_tx_dma(const stm32_usart_t* usart);
 void stm32_usart_enable_rx(const stm32_usart_t* usart);
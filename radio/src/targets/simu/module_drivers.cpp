@@ -23,6 +23,7 @@
 #include "hal/serial_driver.h"
 #include "hal/module_port.h"
 #include "dataconstants.h"
+#include "fifo.h"
 
 void intmoduleStop() {}
 void intmoduleFifoError() {}
@@ -60,12 +61,73 @@ void stop_trainer_module_sbus() {}
 void init_intmodule_heartbeat() {}
 void stop_intmodule_heartbeat() {}
 
-static void* init(void*, const etx_serial_init*) { return (void*)1; }
-static void deinit(void*) {}
+// Serial ports with a RX ring buffer, filled by simuSerialReceive()
+#define SIMU_SERIAL_PORTS          8
+#define SIMU_SERIAL_RX_BUFFER_SIZE 256
+
+struct SimuSerialState {
+  bool used;
+  Fifo<uint8_t, SIMU_SERIAL_RX_BUFFER_SIZE> rx;
+};
+
+static SimuSerialState _serial_states[SIMU_SERIAL_PORTS];
+
+static void* init(void*, const etx_serial_init*)
+{
+  for (auto& st : _serial_states) {
+    if (!st.used) {
+      st.used = true;
+      st.rx.clear();
+      return (void*)&st;
+    }
+  }
+  return nullptr;
+}
+
+static void deinit(void* ctx)
+{
+  auto st = (SimuSerialState*)ctx;
+  if (st) st->used = false;
+}
+
 static void sendByte(void*, uint8_t) {}
 static void sendBuffer(void*, const uint8_t*, uint32_t) {}
 static void waitForTxCompleted(void*) {}
-static int getByte(void*,uint8_t*) { return -1; }
+
+static int getByte(void* ctx, uint8_t* data)
+{
+  auto st = (SimuSerialState*)ctx;
+  if (!st) return -1;
+  return st->rx.pop(*data) ? 1 : 0;
+}
+
+static int getRxSpan(void* ctx, const uint8_t** data)
+{
+  auto st = (SimuSerialState*)ctx;
+  if (!st) return -1;
+  return st->rx.readSpan(data);
+}
+
+static void skipRxBytes(void* ctx, uint32_t len)
+{
+  auto st = (SimuSerialState*)ctx;
+  if (st) st->rx.skip(len);
+}
+
+static void clearRxBuffer(void* ctx)
+{
+  auto st = (SimuSerialState*)ctx;
+  if (st) st->rx.clear();
+}
+
+void simuSerialReceive(void* ctx, const uint8_t* data, uint32_t len)
+{
+  auto st = (SimuSerialState*)ctx;
+  if (!st) return;
+  while (len--) {
+    st->rx.push(*data++);
+  }
+}
 
 const etx_serial_driver_t _fakeSerialDriver = {
     .init = init,
@@ -76,8 +138,10 @@ const etx_serial_driver_t _fakeSerialDriver = {
     .waitForTxCompleted = waitForTxCompleted,
     .enableRx = nullptr,
     .getByte = getByte,
+    .getRxSpan = getRxSpan,
+    .skipRxBytes = skipRxBytes,
     .getLastByte = nullptr,
-    .clearRxBuffer = nullptr,
+    .clearRxBuffer = clearRxBuffer,
     .getBaudrate = nullptr,
     .setBaudrate = nullptr,
     .setPolarity = nullptr,
@@ -85,6 +149,7 @@ const etx_serial_driver_t _fakeSerialDriver = {
     .setReceiveCb = nullptr,
     .setIdleCb = nullptr,
     .setBaudrateCb = nullptr,
+    .setTxCompleteCb = nullptr,
 };
 
 static void* module_timer_init(void* hw_def, const etx_timer_config_t* cfg)
@@ -687,6 +687,8 @@ static const etx_serial_driver_t _fake_drv = {
   .waitForTxCompleted = nullptr,
   .enableRx = nullptr,
   .getByte = _fake_drv_get_byte,
+  .getRxSpan = nullptr,
+  .skipRxBytes = nullptr,
   .getLastByte = nullptr,
   .clearRxBuffer = nullptr,
   .getBaudrate = nullptr,
@@ -696,6 +698,7 @@ static const etx_serial_driver_t _fake_drv = {
   .setReceiveCb = nullptr,
   .setIdleCb = nullptr,
   .setBaudrateCb = nullptr,
+  .setTxCompleteCb = nullptr,
 };
 #endif
 
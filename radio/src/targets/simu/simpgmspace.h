@@ -209,6 +209,9 @@ void simuSetKey(uint8_t key, bool state);
 void simuSetTrim(uint8_t trim, bool state);
 void simuSetSwitch(uint8_t swtch, int8_t state);
 
+// Feed data to a serial port opened on the simulated module drivers
+void simuSerialReceive(void* ctx, const uint8_t* data, uint32_t len);
+
 #if defined(__cplusplus)
 void simuInit();
 void simuStart(bool tests = true, const char * sdPath = nullptr, const char * settingsPath = nullptr);
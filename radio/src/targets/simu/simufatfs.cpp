@@ -44,9 +44,12 @@
   #include <direct.h>
   #include <stdlib.h>
   #include <sys/utime.h>
+  #include <io.h>
   #define mkdir(s, f) _mkdir(s)
+  #define ftruncate(fd, size) _chsize(fd, size)
 #else
   #include <sys/time.h>
+  #include <unistd.h>
   #include <utime.h>
 #endif
 
@@ -334,7 +337,14 @@ FRESULT f_open (FIL * fil, const TCHAR *name, BYTE flag)
     fil->obj.objsize = tmp.st_size;
     fil->fptr = 0;
   }
-  fil->obj.fs = (FATFS*)fopen(realPath.c_str(), (flag & FA_WRITE) ? ((flag & FA_CREATE_ALWAYS) ? "wb+" : "ab+") : "rb");
+  const char* mode = "rb";
+  if (flag & FA_CREATE_ALWAYS)
+    mode = "wb+";
+  else if (flag & (FA_OPEN_ALWAYS | FA_CREATE_NEW))
+    mode = "ab+";
+  else if (flag & FA_WRITE)
+    mode = "rb+"; // existing file, written in place
+  fil->obj.fs = (FATFS*)fopen(realPath.c_str(), mode);
   fil->fptr = 0;
   if (fil->obj.fs) {
     TRACE_SIMPGMSPACE("f_open(%s, %x) = %p (FIL %p)", path.c_str(), flag, fil->obj.fs, fil);
@@ -347,6 +357,8 @@ FRESULT f_open (FIL * fil, const TCHAR *name, BYTE flag)
 FRESULT f_read (FIL* fil, void* data, UINT size, UINT* read)
 {
   if (fil && fil->obj.fs) {
+    // required by stdio between writes and reads
+    fseek((FILE*)fil->obj.fs, 0, SEEK_CUR);
     *read = fread(data, 1, size, (FILE*)fil->obj.fs);
     fil->fptr += *read;
     // TRACE_SIMPGMSPACE("fread(%p) %u, %u", fil->obj.fs, size, *read);
@@ -357,6 +369,7 @@ FRESULT f_read (FIL* fil, void* data, UINT size, UINT* read)
 FRESULT f_write (FIL* fil, const void* data, UINT size, UINT* written)
 {
   if (fil && fil->obj.fs) {
+    fseek((FILE*)fil->obj.fs, 0, SEEK_CUR);
     *written = fwrite(data, 1, size, (FILE*)fil->obj.fs);
     fil->fptr += size;
     // TRACE_SIMPGMSPACE("fwrite(%p) %u, %u", fil->obj.fs, size, *written);
@@ -385,6 +398,17 @@ FRESULT f_lseek (FIL* fil, DWORD offset)
   return FR_OK;
 }
 
+FRESULT f_truncate (FIL* fil)
+{
+  if (fil && fil->obj.fs) {
+    FILE* fp = (FILE*)fil->obj.fs;
+    fflush(fp);
+    if (ftruncate(fileno(fp), ftell(fp)))
+      return FR_DISK_ERR;
+  }
+  return FR_OK;
+}
+
 UINT f_size(FIL* fil)
 {
   if (fil && fil->obj.fs) {
@@ -125,5 +125,7 @@ void tasksStart()
                    AUDIO_STACK_SIZE, AUDIO_TASK_PRIO);
 #endif
 
+  logsTaskInit();
+
   RTOS_START();
 }
@@ -33,23 +33,27 @@
 #define MIXER_STACK_SIZE       400
 #define AUDIO_STACK_SIZE       400
 #define CLI_STACK_SIZE         1024  // only consumed with CLI build option
+#define LOGS_STACK_SIZE        512
 
 #if defined(FREE_RTOS)
 #define MIXER_TASK_PRIO        (tskIDLE_PRIORITY + 4)
 #define AUDIO_TASK_PRIO        (tskIDLE_PRIORITY + 3) // Note: FreeRTOSConfig.h defines software timers as priority 2
 #define MENUS_TASK_PRIO        (tskIDLE_PRIORITY + 1)
 #define CLI_TASK_PRIO          (tskIDLE_PRIORITY + 1)
+#define LOGS_TASK_PRIO         (tskIDLE_PRIORITY + 1)
 #else
 #define MIXER_TASK_PRIO        (4)
 #define AUDIO_TASK_PRIO        (2)
 #define MENUS_TASK_PRIO        (1)
 #define CLI_TASK_PRIO          (1)
+#define LOGS_TASK_PRIO         (1)
 #endif
 
 
 extern TaskStack<MENUS_STACK_SIZE> menusStack;
 extern TaskStack<MIXER_STACK_SIZE> mixerStack;
 extern TaskStack<AUDIO_STACK_SIZE> audioStack;
+extern TaskStack<LOGS_STACK_SIZE> logsStack;
 
 #if defined(CLI)
 extern TaskStack<CLI_STACK_SIZE> cliStack;
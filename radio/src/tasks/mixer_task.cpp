@@ -22,6 +22,8 @@
 #include "tasks.h"
 #include "mixer_task.h"
 #include "mixer_scheduler.h"
+#include "mixer_stats.h"
+#include "latency.h"
 
 #include "opentx.h"
 
@@ -149,6 +151,9 @@ TASK_FUNCTION(mixerTask)
 
   while (!_mixer_exit) {
 
+    // modules to be sent this cycle (all of them if the trigger timed out)
+    uint8_t modules = (1 << MAX_MODULES) - 1;
+
     int timeout = 0;
     for (; timeout < MIXER_MAX_PERIOD; timeout += MIXER_FREQUENT_ACTIONS_PERIOD) {
 
@@ -158,6 +163,7 @@ TASK_FUNCTION(mixerTask)
 
       // mixer flag triggered?
       if (!mixerSchedulerWaitForTrigger(MIXER_FREQUENT_ACTIONS_PERIOD)) {
+        modules = mixerSchedulerGetDueModules();
         break;
       }
     }
@@ -186,12 +192,17 @@ TASK_FUNCTION(mixerTask)
     if (_mixer_running) {
 
       uint16_t t0 = getTmr2MHz();
+      mixerStatsBeginCycle();
 
       DEBUG_TIMER_START(debugTimerMixer);
       mixerTaskLock();
 
       doMixerCalculations();
-      pulsesSendChannels();
+
+      uint16_t pulsesStart = getTmr2MHz();
+      pulsesSendChannels(modules);
+      mixerStatsAdd(MIXER_STAGE_PULSES, pulsesStart);
+
       doMixerPeriodicUpdates();
 
       // TODO: what are these for???
@@ -211,6 +222,9 @@ TASK_FUNCTION(mixerTask)
       // so let's do it here.
       WDG_RESET();
 
+      mixerStatsAdd(MIXER_STAGE_TOTAL, t0);
+      mixerStatsEndCycle();
+
       t0 = getTmr2MHz() - t0;
       if (t0 > maxMixerDuration)
         maxMixerDuration = t0;
@@ -240,15 +254,20 @@ void doMixerCalculations()
   // therefore forget the exact calculation and use only 1 instead; good compromise
   lastTMR = tmr10ms;
 
+  uint16_t t0 = getTmr2MHz();
   DEBUG_TIMER_START(debugTimerGetAdc);
   getADC();
   DEBUG_TIMER_STOP(debugTimerGetAdc);
+  mixerStatsAdd(MIXER_STAGE_ADC, t0);
 
+  t0 = getTmr2MHz();
   DEBUG_TIMER_START(debugTimerGetSwitches);
   getSwitchesPosition(!s_mixer_first_run_done);
   DEBUG_TIMER_STOP(debugTimerGetSwitches);
+  mixerStatsAdd(MIXER_STAGE_SWITCHES, t0);
 
   DEBUG_TIMER_START(debugTimerEvalMixes);
   evalMixes(tick10ms);
   DEBUG_TIMER_STOP(debugTimerEvalMixes);
+  latencyOutputsComputed();
 }
@@ -135,6 +135,20 @@ void telemetryMirrorSend(uint8_t data)
   }
 }
 
+void telemetryMirrorSend(const uint8_t* data, uint32_t len)
+{
+  auto _sendByte = telemetryMirrorSendByte;
+  auto _ctx = telemetryMirrorSendByteCtx;
+
+  // sendBuffer is asynchronous and the RX data is released as soon as
+  // it has been parsed, so the bytes are queued one at a time
+  if (_sendByte) {
+    while (len--) {
+      _sendByte(_ctx, *data++);
+    }
+  }
+}
+
 #if !defined(SIMU)
 static TimerHandle_t telemetryTimer = nullptr;
 static StaticTimer_t telemetryTimerBuffer;
@@ -203,6 +217,22 @@ static inline void pollTelemetry(uint8_t module, const etx_proto_driver_t* drv,
   uint8_t* rxBuffer = getTelemetryRxBuffer(module);
   uint8_t& rxBufferCount = getTelemetryRxBufferCount(module);
 
+  if (drv->processBuffer && serial_drv->getRxSpan && serial_drv->skipRxBytes) {
+    // the received data is handed to the protocol in place
+    const uint8_t* data;
+    int count = serial_drv->getRxSpan(serial_ctx, &data);
+    if (count > 0) {
+      LOG_TELEMETRY_WRITE_START();
+      do {
+        telemetryMirrorSend(data, count);
+        LOG_TELEMETRY_WRITE_BYTES(data, count);
+        drv->processBuffer(ctx, data, count, rxBuffer, &rxBufferCount);
+        serial_drv->skipRxBytes(serial_ctx, count);
+      } while ((count = serial_drv->getRxSpan(serial_ctx, &data)) > 0);
+    }
+    return;
+  }
+
   uint8_t data;
   if (serial_drv->getByte(serial_ctx, &data) > 0) {
     LOG_TELEMETRY_WRITE_START();
@@ -229,12 +259,7 @@ void telemetryWakeup()
   }
   _telemetryIsPolling = false;
 
-  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
-    const TelemetrySensor & sensor = g_model.telemetrySensors[i];
-    if (sensor.type == TELEM_TYPE_CALCULATED) {
-      telemetryItems[i].eval(sensor);
-    }
-  }
+  evalCalculatedSensors();
 
 #if defined(VARIO)
   if (TELEMETRY_STREAMING() && !IS_FAI_ENABLED()) {
@@ -427,6 +452,26 @@ void logTelemetryWriteByte(uint8_t data)
 {
   f_printf(&g_telemetryFile, " %02X", data);
 }
+
+void logTelemetryWriteBytes(const uint8_t* data, uint32_t len)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  char line[3 * 32];
+
+  while (len > 0) {
+    uint32_t count = min<uint32_t>(len, sizeof(line) / 3);
+    char* p = line;
+    for (uint32_t i = 0; i < count; i++) {
+      *p++ = ' ';
+      *p++ = hexDigits[data[i] >> 4];
+      *p++ = hexDigits[data[i] & 0x0F];
+    }
+    UINT written;
+    f_write(&g_telemetryFile, line, p - line, &written);
+    data += count;
+    len -= count;
+  }
+}
 #endif
 
 OutputTelemetryBuffer outputTelemetryBuffer __DMA;
@@ -466,9 +511,34 @@ void ModuleSyncStatus::update(uint16_t newRefreshRate, int16_t newInputLag)
   else if (newRefreshRate > MAX_REFRESH_RATE)
     newRefreshRate = MAX_REFRESH_RATE;
 
+  // the module reports how much later the frame could have arrived:
+  // lock onto that point minus the safety margin
+  int16_t phaseError = newInputLag - mixerSchedulerGetSyncMargin();
+
+  if (isValid() && refreshRate == newRefreshRate && currentLag == 0 &&
+      framesSinceUpdate > 0 &&
+      abs(phaseError) <= framesSinceUpdate * MAX_SYNC_PERIOD_TRIM) {
+    // previous correction fully applied: what is left has drifted in
+    // since then, correct half of it per frame from now on
+    periodTrim += (int32_t)phaseError * 128 / framesSinceUpdate;
+    periodTrim = limit<int32_t>(-MAX_SYNC_PERIOD_TRIM * 256, periodTrim,
+                                MAX_SYNC_PERIOD_TRIM * 256);
+  } else if (refreshRate != newRefreshRate) {
+    periodTrim = 0;
+    periodTrimRemainder = 0;
+  }
+
+  if (phaseErrorCount == 0 || phaseError < phaseErrorMin)
+    phaseErrorMin = phaseError;
+  if (phaseErrorCount == 0 || phaseError > phaseErrorMax)
+    phaseErrorMax = phaseError;
+  phaseErrorAbsSum += abs(phaseError);
+  phaseErrorCount++;
+
   refreshRate = newRefreshRate;
   inputLag    = newInputLag;
-  currentLag  = newInputLag;
+  currentLag  = phaseError;
+  framesSinceUpdate = 0;
   lastUpdate  = get_tmr10ms();
 
 #if 0
@@ -484,14 +554,22 @@ void ModuleSyncStatus::invalidate() {
 uint16_t ModuleSyncStatus::getAdjustedRefreshRate()
 {
   int16_t lag = currentLag;
-  int32_t newRefreshRate = refreshRate;
 
+  if (framesSinceUpdate < UINT16_MAX) {
+    framesSinceUpdate++;
+  }
+
+  periodTrimRemainder += periodTrim;
+  int32_t trim = periodTrimRemainder / 256;
+  periodTrimRemainder -= trim * 256;
+
+  int32_t period = refreshRate + trim;
   if (lag == 0) {
-    return refreshRate;
+    return (uint16_t)period;
   }
-  
-  newRefreshRate += lag;
-  
+
+  int32_t newRefreshRate = period + lag;
+
   if (newRefreshRate < MIN_REFRESH_RATE) {
       newRefreshRate = MIN_REFRESH_RATE;
   }
@@ -499,7 +577,7 @@ uint16_t ModuleSyncStatus::getAdjustedRefreshRate()
     newRefreshRate = MAX_REFRESH_RATE;
   }
 
-  currentLag -= newRefreshRate - refreshRate;
+  currentLag -= newRefreshRate - period;
 #if 0
   TRACE("[SYNC] mod rate = %dus; lag = %dus",newRefreshRate,currentLag);
 #endif
@@ -507,6 +585,19 @@ uint16_t ModuleSyncStatus::getAdjustedRefreshRate()
   return (uint16_t)newRefreshRate;
 }
 
+uint16_t ModuleSyncStatus::getPhaseErrorAverage() const
+{
+  return phaseErrorCount ? phaseErrorAbsSum / phaseErrorCount : 0;
+}
+
+void ModuleSyncStatus::resetStats()
+{
+  phaseErrorCount = 0;
+  phaseErrorAbsSum = 0;
+  phaseErrorMin = 0;
+  phaseErrorMax = 0;
+}
+
 void ModuleSyncStatus::getRefreshString(char * statusText)
 {
   if (!isValid()) {
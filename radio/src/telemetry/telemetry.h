@@ -72,6 +72,7 @@ void telemetrySetMirrorCb(void* ctx, void (*fct)(void*, uint8_t));
 
 // Mirror telemetry byte
 void telemetryMirrorSend(uint8_t data);
+void telemetryMirrorSend(const uint8_t* data, uint32_t len);
 
 void telemetryWakeup();
 void telemetryReset();
@@ -115,9 +116,13 @@ PACK(struct CellValue
 int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, int32_t value, uint32_t unit, uint32_t prec);
 int setTelemetryText(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, const char * text);
 void delTelemetryIndex(uint8_t index);
+void evalCalculatedSensors();
 int availableTelemetryIndex();
 int lastUsedTelemetryIndex();
 
+// To be called when the sensors configuration has been changed
+void telemetrySensorsInvalidate();
+
 int32_t convertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec);
 
 void frskySportSetDefault(int index, uint16_t id, uint8_t subId, uint8_t instance);
@@ -190,11 +195,14 @@ inline uint8_t modelTelemetryProtocol()
 #if defined(LOG_TELEMETRY) && !defined(SIMU)
 void logTelemetryWriteStart();
 void logTelemetryWriteByte(uint8_t data);
+void logTelemetryWriteBytes(const uint8_t* data, uint32_t len);
 #define LOG_TELEMETRY_WRITE_START()    logTelemetryWriteStart()
 #define LOG_TELEMETRY_WRITE_BYTE(data) logTelemetryWriteByte(data)
+#define LOG_TELEMETRY_WRITE_BYTES(data, len) logTelemetryWriteBytes(data, len)
 #else
 #define LOG_TELEMETRY_WRITE_START()
 #define LOG_TELEMETRY_WRITE_BYTE(data)
+#define LOG_TELEMETRY_WRITE_BYTES(data, len)
 #endif
 #define TELEMETRY_OUTPUT_BUFFER_SIZE  64
 
@@ -290,6 +298,8 @@ void processPXX2Frame(uint8_t idx, const uint8_t* frame,
                       const etx_serial_driver_t* drv, void* ctx);
 
 // Module pulse synchronization
+#define MAX_SYNC_PERIOD_TRIM  20 /* us per frame */
+
 struct ModuleSyncStatus
 {
   // feedback input: last received values
@@ -298,7 +308,18 @@ struct ModuleSyncStatus
 
   tmr10ms_t lastUpdate;  // in 10ms
   int16_t   currentLag;  // in us
-  
+
+  // period correction tracking the clock drift between radio and module
+  int32_t   periodTrim;        // in 1/256 us
+  int32_t   periodTrimRemainder;
+  uint16_t  framesSinceUpdate;
+
+  // achieved phase error: reported lag minus safety margin
+  uint32_t  phaseErrorCount;
+  uint32_t  phaseErrorAbsSum;  // in us
+  int16_t   phaseErrorMin;     // in us
+  int16_t   phaseErrorMax;     // in us
+
   inline bool isValid() const {
     // 2 seconds
     return (get_tmr10ms() - lastUpdate < 200);
@@ -316,6 +337,10 @@ struct ModuleSyncStatus
   // Status string for the UI
   void getRefreshString(char* refreshText);
 
+  // Mean absolute phase error
+  uint16_t getPhaseErrorAverage() const;
+  void resetStats();
+
   ModuleSyncStatus();
 };
 
@@ -77,10 +77,25 @@ uint32_t getDistFromEarthAxis(int32_t latitude)
                 12500);
 }
 
+// Items updated since the calculated sensors were last evaluated
+static uint32_t telemetryItemsUpdated[(MAX_TELEMETRY_SENSORS + 31) / 32];
+
+void TelemetryItem::setUpdated()
+{
+  if (this >= telemetryItems && this < telemetryItems + MAX_TELEMETRY_SENSORS) {
+    unsigned index = this - telemetryItems;
+    // set from the telemetry ISR and from several tasks
+    __disable_irq();
+    telemetryItemsUpdated[index >> 5] |= 1u << (index & 31);
+    __enable_irq();
+  }
+}
+
 void TelemetryItem::setValue(const TelemetrySensor & sensor, const char * val, uint32_t, uint32_t)
 {
   strncpy(text, val, sizeof(text));
   setFresh();
+  setUpdated();
 }
 
 void TelemetryItem::setValue(const TelemetrySensor &sensor, int32_t val,
@@ -163,6 +178,7 @@ void TelemetryItem::setValue(const TelemetrySensor &sensor, int32_t val,
     }
     gps.latitude = newVal;
     setFresh();
+    setUpdated();
     return;
   }
   else if (unit == UNIT_GPS_LONGITUDE) {
@@ -176,6 +192,7 @@ void TelemetryItem::setValue(const TelemetrySensor &sensor, int32_t val,
     }
     gps.longitude = newVal;
     setFresh();
+    setUpdated();
     return;
   }
   else if (unit == UNIT_DATETIME_YEAR) {
@@ -264,6 +281,7 @@ void TelemetryItem::setValue(const TelemetrySensor &sensor, int32_t val,
 
   value = newVal;
   setFresh();
+  setUpdated();
 }
 
 void TelemetryItem::per10ms(const TelemetrySensor & sensor)
@@ -462,6 +480,167 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
   }
 }
 
+// The calculated sensors are evaluated in an order where each one comes
+// after the calculated sensors it reads, so that a chain settles in one
+// pass, and only when one of their sources was updated. Sources may be
+// set from other tasks (Lua), so everything is evaluated again once per
+// second in case an update was missed. Sensors reading each other in a
+// loop are left in model order. The order is rebuilt after the sensors
+// have been edited (telemetrySensorsInvalidate()).
+#define CALC_SENSORS_FULL_EVAL_PERIOD  100 // 10ms ticks
+#define CALC_SENSORS_MAX_SOURCES       4
+
+static uint8_t calcSensorsOrder[MAX_TELEMETRY_SENSORS];
+static uint8_t calcSensorsCount;
+static tmr10ms_t calcSensorsFullEvalTime;
+static bool calcSensorsValid = false;
+
+static inline bool isTelemetryItemFlagged(const uint32_t * flags, uint8_t index)
+{
+  return flags[index >> 5] & (1u << (index & 31));
+}
+
+static uint8_t getCalcSensorSources(const TelemetrySensor & sensor, uint8_t * sources)
+{
+  uint8_t count = 0;
+
+  switch (sensor.formula) {
+    case TELEM_FORMULA_CELL:
+      if (sensor.cell.source)
+        sources[count++] = sensor.cell.source - 1;
+      break;
+
+    case TELEM_FORMULA_DIST:
+      if (sensor.dist.gps)
+        sources[count++] = sensor.dist.gps - 1;
+      if (sensor.dist.alt)
+        sources[count++] = sensor.dist.alt - 1;
+      break;
+
+    case TELEM_FORMULA_ADD:
+    case TELEM_FORMULA_AVERAGE:
+    case TELEM_FORMULA_MIN:
+    case TELEM_FORMULA_MAX:
+    case TELEM_FORMULA_MULTIPLY:
+    {
+      int maxitems = (sensor.formula == TELEM_FORMULA_MULTIPLY ? 2 : 4);
+      for (int i = 0; i < maxitems; i++) {
+        int8_t source = sensor.calc.sources[i];
+        if (source)
+          sources[count++] = abs(source) - 1;
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  // an out of range source can't be updated
+  uint8_t result = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (sources[i] < MAX_TELEMETRY_SENSORS)
+      sources[result++] = sources[i];
+  }
+  return result;
+}
+
+static void calcSensorsBuild()
+{
+  uint32_t pending[(MAX_TELEMETRY_SENSORS + 31) / 32] = {0};
+
+  for (uint8_t index = 0; index < MAX_TELEMETRY_SENSORS; index++) {
+    if (g_model.telemetrySensors[index].type == TELEM_TYPE_CALCULATED)
+      pending[index >> 5] |= 1u << (index & 31);
+  }
+
+  calcSensorsCount = 0;
+
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (uint8_t index = 0; index < MAX_TELEMETRY_SENSORS; index++) {
+      if (!isTelemetryItemFlagged(pending, index))
+        continue;
+      uint8_t sources[CALC_SENSORS_MAX_SOURCES];
+      uint8_t count = getCalcSensorSources(g_model.telemetrySensors[index], sources);
+      bool ready = true;
+      for (uint8_t i = 0; i < count; i++) {
+        if (isTelemetryItemFlagged(pending, sources[i])) {
+          ready = false;
+          break;
+        }
+      }
+      if (ready) {
+        calcSensorsOrder[calcSensorsCount++] = index;
+        pending[index >> 5] &= ~(1u << (index & 31));
+        progress = true;
+      }
+    }
+  }
+
+  for (uint8_t index = 0; index < MAX_TELEMETRY_SENSORS; index++) {
+    if (isTelemetryItemFlagged(pending, index))
+      calcSensorsOrder[calcSensorsCount++] = index;
+  }
+}
+
+void evalCalculatedSensors()
+{
+  bool full = false;
+
+  tmr10ms_t now = get_tmr10ms();
+  if (!calcSensorsValid) {
+    calcSensorsValid = true;
+    calcSensorsBuild();
+    full = true;
+  }
+
+  if (full || (tmr10ms_t)(now - calcSensorsFullEvalTime) >= CALC_SENSORS_FULL_EVAL_PERIOD) {
+    calcSensorsFullEvalTime = now;
+    full = true;
+  }
+
+  // the flags are taken over, so that the updates from other tasks during
+  // this pass are kept for the next one
+  uint32_t updated[(MAX_TELEMETRY_SENSORS + 31) / 32];
+  __disable_irq();
+  for (unsigned i = 0; i < DIM(updated); i++) {
+    updated[i] = telemetryItemsUpdated[i];
+    telemetryItemsUpdated[i] = 0;
+  }
+  __enable_irq();
+
+  for (uint8_t i = 0; i < calcSensorsCount; i++) {
+    uint8_t index = calcSensorsOrder[i];
+    const TelemetrySensor & sensor = g_model.telemetrySensors[index];
+
+    if (!full) {
+      uint8_t sources[CALC_SENSORS_MAX_SOURCES];
+      uint8_t count = getCalcSensorSources(sensor, sources);
+      bool dirty = false;
+      for (uint8_t j = 0; j < count; j++) {
+        if (isTelemetryItemFlagged(updated, sources[j])) {
+          dirty = true;
+          break;
+        }
+      }
+      if (!dirty)
+        continue;
+    }
+
+    telemetryItems[index].eval(sensor);
+
+    // the sensors reading this one come later in the order
+    uint32_t mask = 1u << (index & 31);
+    __disable_irq();
+    uint32_t flags = telemetryItemsUpdated[index >> 5];
+    telemetryItemsUpdated[index >> 5] = flags & ~mask;
+    __enable_irq();
+    updated[index >> 5] |= flags & mask;
+  }
+}
+
 void delTelemetryIndex(uint8_t index)
 {
   memclear(&g_model.telemetrySensors[index], sizeof(TelemetrySensor));
@@ -471,6 +650,9 @@ void delTelemetryIndex(uint8_t index)
 
 int availableTelemetryIndex()
 {
+  // the caller is about to add a sensor
+  telemetrySensorsInvalidate();
+
   for (int index=0; index<MAX_TELEMETRY_SENSORS; index++) {
     TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
     if (!telemetrySensor.isAvailable()) {
@@ -491,6 +673,75 @@ int lastUsedTelemetryIndex()
   return -1;
 }
 
+// Index of the custom sensors by (id, subId), so that an incoming value
+// is only compared with the sensors which may receive it. It is an open
+// addressing table of sensor indexes: the sensors sharing the same id are
+// all found in the probe sequence of their key, in model order.
+//
+// The index is rebuilt on the next value after the sensors have been
+// edited (storageDirty(EE_MODEL)) or a new one is about to be discovered
+// (availableTelemetryIndex()).
+#define SENSORS_INDEX_SIZE   256  // power of 2, at least twice the sensors
+#define SENSORS_INDEX_EMPTY  0xFF
+
+static_assert(SENSORS_INDEX_SIZE >= 2 * MAX_TELEMETRY_SENSORS, "sensors index too small");
+
+static uint8_t sensorsIndex[SENSORS_INDEX_SIZE];
+static bool sensorsIndexValid = false;
+
+static inline uint8_t sensorsIndexHash(uint16_t id, uint8_t subId)
+{
+  uint32_t key = ((uint32_t)subId << 16) | id;
+  return (key * 2654435761u) >> 24;
+}
+
+static void sensorsIndexBuild()
+{
+  memset(sensorsIndex, SENSORS_INDEX_EMPTY, sizeof(sensorsIndex));
+
+  for (uint8_t index = 0; index < MAX_TELEMETRY_SENSORS; index++) {
+    const TelemetrySensor & sensor = g_model.telemetrySensors[index];
+    if (sensor.type != TELEM_TYPE_CUSTOM)
+      continue;
+    uint8_t slot = sensorsIndexHash(sensor.id, sensor.subId);
+    while (sensorsIndex[slot] != SENSORS_INDEX_EMPTY)
+      slot = (slot + 1) & (SENSORS_INDEX_SIZE - 1);
+    sensorsIndex[slot] = index;
+  }
+}
+
+static void sensorsIndexUpdate()
+{
+  if (!sensorsIndexValid) {
+    sensorsIndexValid = true;
+    sensorsIndexBuild();
+  }
+}
+
+void telemetrySensorsInvalidate()
+{
+  sensorsIndexValid = false;
+  calcSensorsValid = false;
+}
+
+template <class T>
+static bool setTelemetrySensorValue(uint8_t index, TelemetryProtocol protocol,
+                                    uint16_t id, uint8_t subId, uint8_t instance,
+                                    T value, uint32_t unit, uint32_t prec)
+{
+  TelemetrySensor &telemetrySensor = g_model.telemetrySensors[index];
+
+  if (telemetrySensor.type == TELEM_TYPE_CUSTOM && telemetrySensor.id == id &&
+      telemetrySensor.subId == subId &&
+      (telemetrySensor.isSameInstance(protocol, instance) ||
+       g_model.ignoreSensorIds)) {
+    telemetryItems[index].setValue(telemetrySensor, value, unit, prec);
+    return true;
+  }
+
+  return false;
+}
+
 template <class T>
 int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId,
                       uint8_t instance, T value, uint32_t unit = 0,
@@ -498,19 +749,16 @@ int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId,
 {
   bool sensorFound = false;
 
-  for (int index = 0; index < MAX_TELEMETRY_SENSORS; index++) {
-    TelemetrySensor &telemetrySensor = g_model.telemetrySensors[index];
+  sensorsIndexUpdate();
 
-    if (telemetrySensor.type == TELEM_TYPE_CUSTOM && telemetrySensor.id == id &&
-        telemetrySensor.subId == subId &&
-        (telemetrySensor.isSameInstance(protocol, instance) ||
-         g_model.ignoreSensorIds)) {
-
-      telemetryItems[index].setValue(telemetrySensor, value, unit, prec);
+  // we continue search after a match, because sensors can share the same id
+  // and instance
+  for (uint8_t slot = sensorsIndexHash(id, subId);
+       sensorsIndex[slot] != SENSORS_INDEX_EMPTY;
+       slot = (slot + 1) & (SENSORS_INDEX_SIZE - 1)) {
+    if (setTelemetrySensorValue(sensorsIndex[slot], protocol, id, subId,
+                                instance, value, unit, prec))
       sensorFound = true;
-      // we continue search here, because sensors can share the same id and
-      // instance
-    }
   }
 
   if (sensorFound || !allowNewSensors) {
@@ -97,6 +97,9 @@ class TelemetryItem
 
     void setValue(const TelemetrySensor & sensor, int32_t newVal, uint32_t unit, uint32_t prec=0);
 
+    // flags the item for the calculated sensors reading it
+    void setUpdated();
+
     inline bool isAvailable()
     {
       return (timeout != TELEMETRY_SENSOR_TIMEOUT_UNAVAILABLE);
@@ -129,7 +132,10 @@ class TelemetryItem
 
     inline void setOld()
     {
-      timeout = TELEMETRY_SENSOR_TIMEOUT_OLD;
+      if (timeout != TELEMETRY_SENSOR_TIMEOUT_OLD) {
+        timeout = TELEMETRY_SENSOR_TIMEOUT_OLD;
+        setUpdated();
+      }
     }
 };
 
@@ -20,6 +20,10 @@
  */
 
 #include "gtests.h"
+#include "mixer_scheduler.h"
+#include "hal/module_port.h"
+#include "pulses/crossfire.h"
+#include "telemetry/crossfire.h"
 
 #if defined(CROSSFIRE)
 uint8_t createCrossfireChannelsFrame(uint8_t * frame, int16_t * pulses);
@@ -38,6 +42,92 @@ TEST(Crossfire, createCrossfireChannelsFrame)
   // TODO check
 }
 
+static uint32_t createCrossfireBatteryFrame(uint8_t * frame, uint16_t voltage)
+{
+  frame[0] = RADIO_ADDRESS;
+  frame[1] = 10;  // type + payload + crc
+  frame[2] = BATTERY_ID;
+  frame[3] = voltage >> 8;
+  frame[4] = voltage;
+  memset(&frame[5], 0, 5);  // current, capacity and remaining
+  frame[11] = crc8(&frame[2], frame[1] - 1);
+  return 12;
+}
+
+TEST(Crossfire, processBuffer)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryStreaming = TELEMETRY_TIMEOUT10ms;
+  allowNewSensors = true;
+
+  auto ctx = modulePortGetState(EXTERNAL_MODULE);
+  uint8_t * rxBuffer = getTelemetryRxBuffer(EXTERNAL_MODULE);
+  uint8_t & rxBufferCount = getTelemetryRxBufferCount(EXTERNAL_MODULE);
+  rxBufferCount = 0;
+
+  uint8_t stream[64];
+  uint32_t size = 0;
+  stream[size++] = 0x55;  // noise before the first frame
+  size += createCrossfireBatteryFrame(stream + size, 126);
+  uint32_t second = size;
+  size += createCrossfireBatteryFrame(stream + size, 111);
+  stream[second + 5] ^= 0xFF;  // CRC error
+  size += createCrossfireBatteryFrame(stream + size, 98);
+
+  // blocks which do not match the frames boundaries
+  CrossfireDriver.processBuffer(ctx, stream, 8, rxBuffer, &rxBufferCount);
+  EXPECT_EQ(rxBufferCount, 7);
+  CrossfireDriver.processBuffer(ctx, stream + 8, 5, rxBuffer, &rxBufferCount);
+  EXPECT_EQ(rxBufferCount, 0);
+  EXPECT_EQ(telemetryItems[0].value, 126);
+
+  CrossfireDriver.processBuffer(ctx, stream + 13, size - 13, rxBuffer, &rxBufferCount);
+  EXPECT_EQ(rxBufferCount, 0);
+  EXPECT_EQ(telemetryItems[0].value, 98);
+}
+
+TEST(Crossfire, pollTelemetrySpans)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryStreaming = TELEMETRY_TIMEOUT10ms;
+  allowNewSensors = true;
+
+  modulePortInit();
+  etx_serial_init params = {
+    .baudrate = 0,
+    .encoding = ETX_Encoding_8N1,
+    .direction = ETX_Dir_RX,
+    .polarity = ETX_Pol_Normal,
+  };
+  auto mod_st = modulePortInitSerial(EXTERNAL_MODULE, ETX_MOD_PORT_SPORT, &params);
+  ASSERT_NE(mod_st, nullptr);
+  void* serial_ctx = modulePortGetCtx(mod_st->rx);
+  ASSERT_NE(serial_ctx, nullptr);
+
+  auto mod = pulsesGetModuleDriver(EXTERNAL_MODULE);
+  mod->drv = &CrossfireDriver;
+  mod->ctx = mod_st;
+  getTelemetryRxBufferCount(EXTERNAL_MODULE) = 0;
+
+  // enough frames for the RX buffer to wrap around
+  uint8_t frame[16];
+  for (int i = 0; i < 32; i++) {
+    uint32_t len = createCrossfireBatteryFrame(frame, 100 + i);
+    simuSerialReceive(serial_ctx, frame, len);
+    if (i % 8 == 7) {
+      telemetryWakeup();
+      EXPECT_EQ(telemetryItems[0].value, 100 + i);
+    }
+  }
+  EXPECT_EQ(getTelemetryRxBufferCount(EXTERNAL_MODULE), 0);
+
+  mod->drv = nullptr;
+  mod->ctx = nullptr;
+  modulePortDeInit(mod_st);
+}
+
 TEST(Crossfire, crc8)
 {
   uint8_t frame[] = { 0x00, 0x0C, 0x14, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x01, 0x03, 0x00, 0x00, 0x00, 0xF4 };
@@ -46,3 +136,48 @@ TEST(Crossfire, crc8)
 }
 #endif
 
+
+#if defined(CROSSFIRE)
+// Frames sent with the adjusted period to a module whose clock runs
+// 100ppm slower, which reports the lag every 25 frames.
+static int16_t runModuleSync(ModuleSyncStatus & status, int64_t & arrival,
+                             int frames)
+{
+  const int32_t period = 4000;  // us
+  int16_t lag = 0;
+
+  for (int i = 1; i <= frames; i++) {
+    int32_t adjusted = status.getAdjustedRefreshRate();
+    arrival += adjusted * 10 + adjusted / 1000;
+
+    if (i % 25 == 0) {
+      int32_t phase = arrival % (period * 10);
+      if (phase > period * 5) phase -= period * 10;
+      lag = -phase / 10;
+      status.update(period, lag);
+    }
+  }
+  return lag;
+}
+
+TEST(Crossfire, moduleSyncPhaseLock)
+{
+  ModuleSyncStatus status;
+  int64_t arrival = 12345;  // 1/10 us, module clock
+  status.update(4000, 0);
+
+  runModuleSync(status, arrival, 2000);
+  status.resetStats();
+  runModuleSync(status, arrival, 1000);
+  EXPECT_EQ(status.phaseErrorCount, 40u);
+  EXPECT_LE(status.phaseErrorMax, 2);
+  EXPECT_GE(status.phaseErrorMin, -2);
+
+  // keep the frames 300us ahead of the module
+  mixerSchedulerSetSyncMargin(300);
+  runModuleSync(status, arrival, 2000);
+  int16_t lag = runModuleSync(status, arrival, 1000);
+  mixerSchedulerSetSyncMargin(0);
+  EXPECT_NEAR(lag, 300, 2);
+}
+#endif
@@ -383,6 +383,8 @@ TEST(FrSkySPORT, frskySetCellVoltageTwoSensors)
   g_model.telemetrySensors[2].calc.sources[0] = 1;
   g_model.telemetrySensors[2].calc.sources[1] = 2;
 
+  // the configuration is checked on the next tick
+  g_tmr10ms++;
   telemetryWakeup();
 
   EXPECT_EQ(telemetryItems[2].value, 287);
@@ -530,3 +532,130 @@ TEST(FrSkySPORT, frskyCurrent)
   EXPECT_EQ(telemetryItems[0].valueMax, 505);
 }
 
+
+TEST(FrSkySPORT, sensorsIndex)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  allowNewSensors = true;
+
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 1200, UNIT_VOLTS, 2);
+  EXPECT_EQ(g_model.telemetrySensors[0].id, VFAS_FIRST_ID);
+  EXPECT_EQ(telemetryItems[0].value, 1200);
+  g_tmr10ms++;
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 1150, UNIT_VOLTS, 2);
+  EXPECT_EQ(telemetryItems[0].value, 1150);
+
+  // sensors can share the same id and instance, the index is rebuilt
+  // after the edit (notified as the menus do)
+  g_model.telemetrySensors[1] = g_model.telemetrySensors[0];
+  storageDirty(EE_MODEL);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 1100, UNIT_VOLTS, 2);
+  EXPECT_EQ(telemetryItems[0].value, 1100);
+  EXPECT_EQ(telemetryItems[1].value, 1100);
+
+  // an edited sensor is found right away
+  g_model.telemetrySensors[0].id = VFAS_FIRST_ID + 1;
+  storageDirty(EE_MODEL);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID + 1, 0, 1, 1000, UNIT_VOLTS, 2);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 900, UNIT_VOLTS, 2);
+  EXPECT_EQ(telemetryItems[0].value, 1000);
+  EXPECT_EQ(telemetryItems[1].value, 900);
+  EXPECT_FALSE(g_model.telemetrySensors[2].isAvailable());
+
+  // a new sensor is found as soon as it is added
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID + 2, 0, 1, 800, UNIT_VOLTS, 2);
+  EXPECT_EQ(g_model.telemetrySensors[2].id, VFAS_FIRST_ID + 2);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID + 2, 0, 1, 700, UNIT_VOLTS, 2);
+  EXPECT_EQ(telemetryItems[2].value, 700);
+  EXPECT_FALSE(g_model.telemetrySensors[3].isAvailable());
+
+  // a sensor without a name still receives its values
+  g_model.telemetrySensors[1].label[0] = '\0';
+  storageDirty(EE_MODEL);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 600, UNIT_VOLTS, 2);
+  EXPECT_EQ(telemetryItems[1].value, 600);
+}
+
+TEST(FrSkySPORT, calculatedSensorsChain)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryStreaming = TELEMETRY_TIMEOUT10ms;
+  allowNewSensors = true;
+
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 1200, UNIT_VOLTS, 2);
+  EXPECT_EQ(g_model.telemetrySensors[0].id, VFAS_FIRST_ID);
+
+  // sensor 2 reads sensor 3 which reads sensor 1
+  g_model.telemetrySensors[1].type = TELEM_TYPE_CALCULATED;
+  g_model.telemetrySensors[1].formula = TELEM_FORMULA_ADD;
+  g_model.telemetrySensors[1].unit = UNIT_VOLTS;
+  g_model.telemetrySensors[1].prec = 2;
+  g_model.telemetrySensors[1].calc.sources[0] = 3;
+  g_model.telemetrySensors[1].calc.sources[1] = 3;
+  g_model.telemetrySensors[2].type = TELEM_TYPE_CALCULATED;
+  g_model.telemetrySensors[2].formula = TELEM_FORMULA_ADD;
+  g_model.telemetrySensors[2].unit = UNIT_VOLTS;
+  g_model.telemetrySensors[2].prec = 2;
+  g_model.telemetrySensors[2].calc.sources[0] = 1;
+
+  // the order is rebuilt after the edit (notified as the menus do)
+  storageDirty(EE_MODEL);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[2].value, 1200);
+  EXPECT_EQ(telemetryItems[1].value, 2400);
+
+  // the chain settles in one pass
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 1100, UNIT_VOLTS, 2);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[2].value, 1100);
+  EXPECT_EQ(telemetryItems[1].value, 2200);
+
+  // nothing is evaluated while the sources don't change
+  telemetryItems[1].value = 0;
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[1].value, 0);
+
+  // a source getting old is propagated
+  telemetryItems[0].setOld();
+  evalCalculatedSensors();
+  EXPECT_TRUE(telemetryItems[2].isOld());
+  EXPECT_TRUE(telemetryItems[1].isOld());
+
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, VFAS_FIRST_ID, 0, 1, 1000, UNIT_VOLTS, 2);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[1].value, 2000);
+  EXPECT_FALSE(telemetryItems[1].isOld());
+}
+
+TEST(FrSkySPORT, calculatedSensorsDistance)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryStreaming = TELEMETRY_TIMEOUT10ms;
+  allowNewSensors = true;
+
+  // the first position is taken as the pilot position
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, GPS_LONG_LATI_FIRST_ID, 0, 1, 45000000, UNIT_GPS_LATITUDE, 0);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, GPS_LONG_LATI_FIRST_ID, 0, 1, 7000000, UNIT_GPS_LONGITUDE, 0);
+  EXPECT_EQ(g_model.telemetrySensors[0].unit, UNIT_GPS);
+
+  g_model.telemetrySensors[1].type = TELEM_TYPE_CALCULATED;
+  g_model.telemetrySensors[1].formula = TELEM_FORMULA_DIST;
+  g_model.telemetrySensors[1].unit = UNIT_METERS;
+  g_model.telemetrySensors[1].dist.gps = 1;
+
+  storageDirty(EE_MODEL);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[1].value, 0);
+
+  // a new position alone is enough to update the distance
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, GPS_LONG_LATI_FIRST_ID, 0, 1, 45001000, UNIT_GPS_LATITUDE, 0);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[1].value, 111);
+
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, GPS_LONG_LATI_FIRST_ID, 0, 1, 7001000, UNIT_GPS_LONGITUDE, 0);
+  evalCalculatedSensors();
+  EXPECT_GT(telemetryItems[1].value, 111);
+}
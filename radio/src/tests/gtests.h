@@ -91,6 +91,7 @@ inline void TELEMETRY_RESET()
     telemetryItems[i].clear();
   }
   memclear(g_model.telemetrySensors, sizeof(g_model.telemetrySensors));
+  telemetrySensorsInvalidate();
 }
 
 class OpenTxTest : public testing::Test 
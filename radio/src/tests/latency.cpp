@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "latency.h"
+
+static void latencySendFrame(tmr10ms_t ticks)
+{
+  latencyAdcSampled();
+  latencyOutputsComputed();
+  g_tmr10ms += ticks;
+  latencyFrameQueued(0, latencyOutputsTimestamp());
+}
+
+TEST(Latency, slowFrames)
+{
+  latencyMeasureStart();
+
+  // beyond the 2MHz timer period, the 10ms tick gives the wraps
+  latencySendFrame(3);
+  const ModuleLatencyStats & stats = latencyGetStats(0);
+  EXPECT_EQ(1u, stats.count);
+  EXPECT_GT(stats.max, 20000);
+  EXPECT_LT(stats.max, 40000);
+
+  // saturated, not dropped
+  latencySendFrame(10);
+  EXPECT_EQ(2u, stats.count);
+  EXPECT_EQ(UINT16_MAX, stats.max);
+  EXPECT_EQ(2u, stats.buckets[LATENCY_BUCKETS - 1]);
+  EXPECT_EQ(UINT16_MAX, latencyPercentile(0, 99));
+
+  latencyMeasureStop();
+  latencyMeasureReset();
+}
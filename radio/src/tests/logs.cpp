@@ -0,0 +1,534 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdarg.h>
+#include <string>
+#include <vector>
+
+#include "gtests.h"
+#include "location.h"
+#include "logs_binary.h"
+#include "logs_queue.h"
+
+TEST(Logs, binaryDeltas)
+{
+  const int32_t values[] = { 0, 1, -1, 1500, 1499, INT32_MAX, INT32_MIN, 0, -52000000 };
+  uint8_t buffer[sizeof(values) / sizeof(values[0]) * LOG_BINARY_VARINT_MAXLEN];
+  uint32_t size = 0;
+
+  int32_t prev = 0;
+  for (auto value: values) {
+    size += logBinaryPutVarint(buffer + size, logBinaryZigzag(int32_t(uint32_t(value) - uint32_t(prev))));
+    prev = value;
+  }
+
+  // small changes take a single byte
+  EXPECT_EQ(buffer[0], 0);
+  EXPECT_EQ(buffer[1], 2);
+  EXPECT_EQ(buffer[2], 3);
+
+  const uint8_t * p = buffer;
+  prev = 0;
+  for (auto value: values) {
+    uint32_t delta;
+    uint8_t len = logBinaryGetVarint(p, buffer + size - p, delta);
+    ASSERT_NE(len, 0);
+    p += len;
+    prev = int32_t(uint32_t(prev) + uint32_t(logBinaryUnzigzag(delta)));
+    EXPECT_EQ(prev, value);
+  }
+  EXPECT_EQ(p, buffer + size);
+
+  // a truncated value is detected
+  uint32_t delta;
+  EXPECT_EQ(logBinaryGetVarint(buffer + 3, 1, delta), 0);
+}
+
+TEST(Logs, queueCommit)
+{
+  LogsQueue<16> queue;
+  const uint8_t row[] = { 1, 2, 3, 4, 5 };
+
+  // a row is only seen once committed
+  queue.begin();
+  queue.put(row, 2);
+  queue.put(row + 2, 3);
+  EXPECT_EQ(queue.size(), 0u);
+  EXPECT_TRUE(queue.commit());
+  EXPECT_EQ(queue.size(), 5u);
+
+  uint8_t value;
+  for (auto expected: row) {
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, expected);
+  }
+  EXPECT_TRUE(queue.isEmpty());
+
+  // the rows go on across the end of the buffer
+  for (int i = 0; i < 4; i++) {
+    queue.begin();
+    queue.put(row, sizeof(row));
+    EXPECT_TRUE(queue.commit());
+    for (auto expected: row) {
+      ASSERT_TRUE(queue.pop(value));
+      EXPECT_EQ(value, expected);
+    }
+  }
+  EXPECT_TRUE(queue.isEmpty());
+}
+
+TEST(Logs, queueOverflow)
+{
+  LogsQueue<16> queue;
+  const uint8_t row[] = { 1, 2, 3, 4, 5 };
+
+  for (int i = 0; i < 3; i++) {
+    queue.begin();
+    queue.put(row, sizeof(row));
+    EXPECT_TRUE(queue.commit());
+  }
+  EXPECT_EQ(queue.size(), 15u);
+
+  // a row which does not fit is dropped as a whole, even the part put
+  // before the queue was full
+  queue.begin();
+  queue.put(row, 0);
+  queue.put(row, 1);
+  queue.put(row, 1);
+  EXPECT_FALSE(queue.commit());
+  EXPECT_EQ(queue.size(), 15u);
+
+  // the next row is kept once there is room again
+  queue.skip(5);
+  queue.begin();
+  queue.put(row + 4, 1);
+  queue.put(row, 4);
+  EXPECT_TRUE(queue.commit());
+  EXPECT_EQ(queue.size(), 15u);
+
+  const uint8_t expected[] = { 1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 5, 1, 2, 3, 4 };
+  uint8_t value;
+  for (auto byte: expected) {
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, byte);
+  }
+  EXPECT_TRUE(queue.isEmpty());
+}
+
+#if defined(SDCARD)
+uint32_t getLogicalSwitchesStates(uint8_t first);
+
+#define LOGS_TEST_MODEL  "Logs"
+
+static void logsTestStart()
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  strcpy(g_model.header.name, LOGS_TEST_MODEL);
+  g_rtcTime = 1700000000;
+  g_ms100 = 5;
+  g_tmr10ms = 1000;
+  logsResetStats();
+  modelFunctionsContext.activeFunctions = 1 << FUNCTION_LOGS;
+  logDelay100ms = 1;
+}
+
+static void logsTestNextRow(int16_t stick)
+{
+  g_tmr10ms += 10;
+  calibratedAnalogs[0] = stick;
+  channelOutputs[0] = 2 * stick;
+}
+
+// Returns the content of the log written by the test and deletes it
+static std::string logsTestRead()
+{
+  std::string content;
+  DIR dir;
+  FILINFO fno;
+  if (f_opendir(&dir, LOGS_PATH) != FR_OK)
+    return content;
+  while (f_readdir(&dir, &fno) == FR_OK) {
+    if (strncmp(fno.fname, LOGS_TEST_MODEL "-", sizeof(LOGS_TEST_MODEL)))
+      continue;
+    std::string path = std::string(LOGS_PATH "/") + fno.fname;
+    FIL file;
+    if (f_open(&file, path.c_str(), FA_READ) == FR_OK) {
+      char buffer[256];
+      UINT read;
+      while (f_read(&file, buffer, sizeof(buffer), &read) == FR_OK && read > 0) {
+        content.append(buffer, read);
+      }
+      f_close(&file);
+    }
+    f_unlink(path.c_str());
+  }
+  f_closedir(&dir);
+  return content;
+}
+
+static void logsTestEnd()
+{
+  modelFunctionsContext.activeFunctions = 0;
+  logDelay100ms = 0;
+  simuFatfsSetPaths("", "");
+}
+
+#if !defined(LOG_BINARY)
+static void appendf(std::string & s, const char * format, ...)
+{
+  char buffer[64];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  s += buffer;
+}
+
+// The header and the rows as they were written with f_printf()
+static std::string csvHeader()
+{
+  std::string s;
+#if defined(RTCLOCK)
+  s += "Date,Time,";
+#else
+  s += "Time,";
+#endif
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    TelemetrySensor & sensor = g_model.telemetrySensors[i];
+    if (sensor.isAvailable() && sensor.logs) {
+      char label[TELEM_LABEL_LEN+7];
+      memset(label, 0, sizeof(label));
+      strncpy(label, sensor.label, TELEM_LABEL_LEN);
+      uint8_t unit = sensor.unit;
+      if (unit == UNIT_CELLS ) unit = UNIT_VOLTS;
+      if (UNIT_RAW < unit && unit < UNIT_FIRST_VIRTUAL) {
+        strcat(label, "(");
+        strncat(label, STR_VTELEMUNIT[unit], 3);
+        strcat(label, ")");
+      }
+      s += label;
+      s += ",";
+    }
+  }
+#if defined(PCBFRSKY) || defined(PCBNV14)
+  for (uint8_t i=1; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS+1; i++) {
+    s += STR_VSRCRAW[i] + 2;
+    s += ",";
+  }
+  for (uint8_t i=0; i<NUM_SWITCHES; i++) {
+    if (SWITCH_EXISTS(i)) {
+      char name[LEN_SWITCH_NAME + 2];
+      *getSwitchName(name, SWSRC_FIRST_SWITCH + i * 3) = '\0';
+      s += name;
+      s += ",";
+    }
+  }
+  s += "LSW,";
+  for (uint8_t channel = 0; channel < MAX_OUTPUT_CHANNELS; channel++) {
+    appendf(s, "CH%d(us),", channel+1);
+  }
+#else
+  s += "Rud,Ele,Thr,Ail,P1,P2,P3,THR,RUD,ELE,3POS,AIL,GEA,TRN,";
+#endif
+  s += "TxBat(V)\n";
+  return s;
+}
+
+static std::string csvRow()
+{
+  std::string s;
+#if defined(RTCLOCK)
+  struct gtm utm;
+  gettime(&utm);
+  appendf(s, "%4d-%02d-%02d,%02d:%02d:%02d.%02d0,", utm.tm_year+TM_YEAR_BASE, utm.tm_mon+1, utm.tm_mday, utm.tm_hour, utm.tm_min, utm.tm_sec, g_ms100);
+#else
+  appendf(s, "%d,", g_tmr10ms);
+#endif
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    TelemetrySensor & sensor = g_model.telemetrySensors[i];
+    TelemetryItem & telemetryItem = telemetryItems[i];
+    if (!sensor.isAvailable() || !sensor.logs)
+      continue;
+    if (sensor.unit == UNIT_GPS) {
+      if (telemetryItem.gps.longitude && telemetryItem.gps.latitude) {
+        div_t qr = div((int)telemetryItem.gps.latitude, 1000000);
+        if (telemetryItem.gps.latitude < 0) s += "-";
+        appendf(s, "%d.%06d ", abs(qr.quot), abs(qr.rem));
+        qr = div((int)telemetryItem.gps.longitude, 1000000);
+        if (telemetryItem.gps.longitude < 0) s += "-";
+        appendf(s, "%d.%06d,", abs(qr.quot), abs(qr.rem));
+      }
+      else {
+        s += ",";
+      }
+    }
+    else if (sensor.unit == UNIT_DATETIME) {
+      appendf(s, "%4d-%02d-%02d %02d:%02d:%02d,", telemetryItem.datetime.year, telemetryItem.datetime.month, telemetryItem.datetime.day, telemetryItem.datetime.hour, telemetryItem.datetime.min, telemetryItem.datetime.sec);
+    }
+    else if (sensor.unit == UNIT_TEXT) {
+      appendf(s, "\"%s\",", telemetryItem.text);
+    }
+    else if (sensor.prec == 2) {
+      div_t qr = div((int)telemetryItem.value, 100);
+      if (telemetryItem.value < 0) s += "-";
+      appendf(s, "%d.%02d,", abs(qr.quot), abs(qr.rem));
+    }
+    else if (sensor.prec == 1) {
+      div_t qr = div((int)telemetryItem.value, 10);
+      if (telemetryItem.value < 0) s += "-";
+      appendf(s, "%d.%d,", abs(qr.quot), abs(qr.rem));
+    }
+    else {
+      appendf(s, "%d,", telemetryItem.value);
+    }
+  }
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    appendf(s, "%d,", calibratedAnalogs[i]);
+  }
+#if defined(PCBFRSKY) || defined(PCBFLYSKY)
+  for (uint8_t i=0; i<NUM_SWITCHES; i++) {
+    if (SWITCH_EXISTS(i)) {
+      int value = getValue(MIXSRC_FIRST_SWITCH + i);
+      appendf(s, "%d,", (value == 0) ? 0 : (value < 0) ? -1 : +1);
+    }
+  }
+  appendf(s, "0x%08X%08X,", getLogicalSwitchesStates(32), getLogicalSwitchesStates(0));
+  for (uint8_t channel = 0; channel < MAX_OUTPUT_CHANNELS; channel++) {
+    appendf(s, "%d,", PPM_CENTER+channelOutputs[channel]/2);
+  }
+#else
+  appendf(s, "%d,%d,%d,%d,%d,%d,%d,",
+          switchState(SW_THR) ? -1 : 1, switchState(SW_RUD) ? -1 : 1,
+          switchState(SW_ELE) ? -1 : 1,
+          switchState(SW_ID0) ? -1 : (switchState(SW_ID2) ? 1 : 0),
+          switchState(SW_AIL) ? -1 : 1, switchState(SW_GEA) ? -1 : 1,
+          switchState(SW_TRN) ? -1 : 1);
+#endif
+  div_t qr = div(g_vbat100mV, 10);
+  appendf(s, "%d.%d\n", abs(qr.quot), abs(qr.rem));
+  return s;
+}
+
+static void setLogsTestSensor(uint8_t index, const char * label, uint8_t unit, uint8_t prec = 0)
+{
+  TelemetrySensor & sensor = g_model.telemetrySensors[index];
+  strncpy(sensor.label, label, TELEM_LABEL_LEN);
+  sensor.unit = unit;
+  sensor.prec = prec;
+  sensor.logs = 1;
+}
+
+TEST(Logs, csvRows)
+{
+  logsTestStart();
+  logsTestRead();
+
+  setLogsTestSensor(0, "Alt", UNIT_METERS);
+  setLogsTestSensor(1, "VFAS", UNIT_VOLTS, 2);
+  setLogsTestSensor(2, "Curr", UNIT_AMPS, 1);
+  setLogsTestSensor(3, "GPS", UNIT_GPS);
+  setLogsTestSensor(4, "Date", UNIT_DATETIME);
+  setLogsTestSensor(5, "Mode", UNIT_TEXT);
+  setLogsTestSensor(6, "Cels", UNIT_CELLS, 2);
+  setLogsTestSensor(7, "RSSI", UNIT_DB);
+  g_model.telemetrySensors[7].logs = 0;
+
+  telemetryItems[0].value = -12;
+  telemetryItems[1].value = -5;
+  telemetryItems[2].value = 7;
+  telemetryItems[6].value = 370;
+  g_vbat100mV = 82;
+
+  std::string expected = csvHeader();
+
+  logsTestNextRow(-1024);
+  logsWrite();
+  expected += csvRow();
+
+  telemetryItems[0].value = 1500;
+  telemetryItems[1].value = 1234;
+  telemetryItems[2].value = -123;
+  telemetryItems[3].gps.latitude = -33856789;
+  telemetryItems[3].gps.longitude = 151215001;
+  telemetryItems[4].datetime.year = 2023;
+  telemetryItems[4].datetime.month = 11;
+  telemetryItems[4].datetime.day = 4;
+  telemetryItems[4].datetime.hour = 9;
+  telemetryItems[4].datetime.min = 5;
+  telemetryItems[4].datetime.sec = 30;
+  strcpy(telemetryItems[5].text, "ACRO");
+  g_vbat100mV = 119;
+  logsTestNextRow(1000);
+  logsWrite();
+  expected += csvRow();
+
+  telemetryItems[3].gps.latitude = 48000000;
+  telemetryItems[3].gps.longitude = -2500000;
+  telemetryItems[4].datetime.year = 99;
+  logsTestNextRow(-7);
+  logsWrite();
+  expected += csvRow();
+
+  logsProcess();
+  logsClose();
+  EXPECT_EQ(logsTestRead(), expected);
+  EXPECT_EQ(logsGetStats().rows, 3U);
+  EXPECT_EQ(logsGetStats().droppedRows, 0U);
+
+  logsTestEnd();
+}
+
+TEST(Logs, csvDroppedRows)
+{
+  logsTestStart();
+  logsTestRead();
+
+  // the logs task does not run, the queue gets full
+  std::string expected = csvHeader();
+  for (int i = 0; i < 40; i++) {
+    uint32_t dropped = logsGetStats().droppedRows;
+    logsTestNextRow(i);
+    logsWrite();
+    if (logsGetStats().droppedRows == dropped)
+      expected += csvRow();
+  }
+  EXPECT_GT(logsGetStats().droppedRows, 0U);
+  EXPECT_LT(logsGetStats().droppedRows, 40U);
+
+  // and the rows are queued again once it is written
+  logsProcess();
+  for (int i = 100; i < 105; i++) {
+    logsTestNextRow(i);
+    logsWrite();
+    expected += csvRow();
+  }
+
+  logsClose();
+  EXPECT_EQ(logsTestRead(), expected);
+  EXPECT_EQ(logsGetStats().rows + logsGetStats().droppedRows, 45U);
+
+  logsTestEnd();
+}
+#else
+struct BinaryLog {
+  uint8_t headers = 0;
+  std::vector<std::string> labels;  // one per value
+  std::vector<std::vector<int32_t>> rows;
+};
+
+static bool parseBinaryLog(const std::string & content, BinaryLog & log)
+{
+  auto data = (const uint8_t *)content.data();
+  uint32_t size = content.size();
+  uint32_t pos = 0;
+  std::vector<int32_t> values;
+
+  while (pos < size) {
+    uint8_t tag = data[pos++];
+    if (tag == LOG_BINARY_TAG_HEADER) {
+      if (size - pos < LOG_BINARY_MAGIC_LEN + 1 ||
+          memcmp(data + pos, LOG_BINARY_MAGIC, LOG_BINARY_MAGIC_LEN) ||
+          data[pos + LOG_BINARY_MAGIC_LEN] != LOG_BINARY_VERSION)
+        return false;
+      pos += LOG_BINARY_MAGIC_LEN + 1;
+      log.labels.clear();
+      while (pos < size && data[pos] != LOG_FIELD_END) {
+        if (size - pos < 3)
+          return false;
+        uint8_t kind = data[pos];
+        uint8_t len = data[pos + 2];
+        pos += 3;
+        // no text sensor in these logs
+        if (kind == LOG_FIELD_TEXT || size - pos < len)
+          return false;
+        for (uint8_t i = 0; i < logFieldValuesCount(kind); i++) {
+          log.labels.push_back(std::string((const char *)data + pos, len));
+        }
+        pos += len;
+      }
+      pos++;
+      // the deltas start again from 0
+      values.assign(log.labels.size(), 0);
+      log.headers++;
+    }
+    else if (tag == LOG_BINARY_TAG_ROW && log.headers > 0) {
+      for (auto & value: values) {
+        uint32_t delta;
+        uint8_t len = logBinaryGetVarint(data + pos, size - pos, delta);
+        if (!len)
+          return false;
+        pos += len;
+        value = int32_t(uint32_t(value) + uint32_t(logBinaryUnzigzag(delta)));
+      }
+      log.rows.push_back(values);
+    }
+    else {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(Logs, binaryHeaderAfterDrop)
+{
+  logsTestStart();
+  logsTestRead();
+
+  // the logs task does not run, the queue gets full
+  std::vector<int16_t> expected;
+  for (int i = 0; i < 400; i++) {
+    uint32_t dropped = logsGetStats().droppedRows;
+    logsTestNextRow(i * 3 - 600);
+    logsWrite();
+    if (logsGetStats().droppedRows == dropped)
+      expected.push_back(calibratedAnalogs[0]);
+  }
+  EXPECT_GT(logsGetStats().droppedRows, 0U);
+
+  logsProcess();
+  for (int i = 0; i < 5; i++) {
+    logsTestNextRow(1000 + i);
+    logsWrite();
+    expected.push_back(calibratedAnalogs[0]);
+  }
+  logsClose();
+
+  BinaryLog log;
+  ASSERT_TRUE(parseBinaryLog(logsTestRead(), log));
+  EXPECT_EQ(log.headers, 2);
+
+  // the rows after the drop are read from the new header
+  unsigned column = 0;
+  while (column < log.labels.size() && log.labels[column] != STR_VSRCRAW[1] + 2) {
+    column++;
+  }
+  ASSERT_LT(column, log.labels.size());
+  ASSERT_EQ(log.rows.size(), expected.size());
+  for (unsigned i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(log.rows[i][column], expected[i]);
+  }
+
+  logsTestEnd();
+}
+#endif
+#endif
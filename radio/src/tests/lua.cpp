@@ -26,6 +26,7 @@
 
 #define SWAP_DEFINED
 #include "opentx.h"
+#include "mixer_plan.h"
 
 
 ::testing::AssertionResult __luaExecStr(const char * str)
@@ -164,4 +165,27 @@ TEST(Lua, testModelInputs)
 
 }
 
+TEST(Lua, testModelMixesEdits)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+  std::string max = std::to_string(MIXSRC_MAX);
+
+  luaExecStr(("model.insertMix(0, 0, {source=" + max + ", weight=100})").c_str());
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX);
+
+  // the mixer follows the script edits right away, as the wizards expect
+  luaExecStr("model.deleteMixes()");
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(mixerPlan.count, 0);
+  EXPECT_EQ(chans[0], 0);
+
+  luaExecStr(("model.insertMix(1, 0, {source=" + max + ", weight=50})").c_str());
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(mixerPlan.count, 1);
+  EXPECT_EQ(chans[0], 0);
+  EXPECT_EQ(chans[1], CHANNEL_MAX / 2);
+}
+
 #endif   // #if defined(LUA)
@@ -20,6 +20,8 @@
  */
 
 #include "gtests.h"
+#include "mixer_plan.h"
+#include "mixer_scheduler.h"
 
 class TrimsTest : public OpenTxTest {};
 class MixerTest : public OpenTxTest {};
@@ -489,6 +491,53 @@ TEST(Curves, LinearIntpol)
   EXPECT_EQ(applyCustomCurve(-192, 0), -192);
 }
 
+int16_t hermite_spline(int16_t x, uint8_t idx);
+
+TEST(Curves, SmoothLut)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  setModelDefaults();
+
+  // 17 points smooth curve, then a 9 points custom one
+  static const int8_t points[] = {
+    -100, -90, -60, -55, -40, -10, -5, 0, 10, 35, 40, 42, 80, 85, 95, 99, 100,
+    -100, -20, 30, 30, 60, 10, -50, 70, 100,
+    -90, -60, -20, 0, 10, 40, 80
+  };
+  memcpy(g_model.points, points, sizeof(points));
+  g_model.curves[0].points = 12;
+  g_model.curves[0].smooth = 1;
+  g_model.curves[1].type = CURVE_TYPE_CUSTOM;
+  g_model.curves[1].points = 4;
+  g_model.curves[1].smooth = 1;
+  loadCurves();
+
+  int maxError = 0;
+  for (uint8_t idx = 0; idx < 2; idx++) {
+    for (int x = -RESX - 10; x <= RESX + 10; x++) {
+      int error = abs(applyCustomCurve(x, idx) - hermite_spline(x, idx));
+      maxError = max(maxError, error);
+    }
+  }
+  // within 0.2% of the spline
+  EXPECT_LE(maxError, RESX / 256);
+
+  // an edit only reaches the tables through the model change
+  g_model.points[8] = -50;
+  curvesLutUpdate();
+  EXPECT_NE(applyCustomCurve(0, 0), hermite_spline(0, 0));
+
+  // the spline is used until the tables are rebuilt
+  storageDirty(EE_MODEL);
+  EXPECT_EQ(applyCustomCurve(0, 0), hermite_spline(0, 0));
+  curvesLutUpdate();
+  EXPECT_EQ(applyCustomCurve(0, 0), hermite_spline(0, 0));
+  g_model.points[8] = 0;
+  EXPECT_NE(applyCustomCurve(0, 0), hermite_spline(0, 0));
+}
+
 
 
 TEST_F(MixerTest, InfiniteRecursiveChannels)
@@ -508,6 +557,40 @@ TEST_F(MixerTest, InfiniteRecursiveChannels)
   EXPECT_EQ(chans[0], 0);
 }
 
+TEST_F(MixerTest, ChainedChannelsSinglePass)
+{
+  // CH1 <- CH2 <- ... <- CH8 <- MAX: deeper than the old 5 passes limit
+  for (int i = 0; i < 8; i++) {
+    g_model.mixData[i].destCh = i;
+    g_model.mixData[i].srcRaw = (i == 7 ? MIXSRC_MAX : MIXSRC_CH1 + i + 1);
+    g_model.mixData[i].weight = 100;
+  }
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_TRUE(mixerPlan.ordered);
+  EXPECT_EQ(mixerPlan.loopChannels, 0u);
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(chans[i], CHANNEL_MAX);
+  }
+}
+
+TEST_F(MixerTest, ChannelsLoopDetection)
+{
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].srcRaw = MIXSRC_CH2;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].srcRaw = MIXSRC_CH1;
+  g_model.mixData[1].weight = 100;
+  g_model.mixData[2].destCh = 2;
+  g_model.mixData[2].srcRaw = MIXSRC_CH1;
+  g_model.mixData[2].weight = 100;
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_FALSE(mixerPlan.ordered);
+  EXPECT_TRUE(mixerPlanChannelInLoop(0));
+  EXPECT_TRUE(mixerPlanChannelInLoop(1));
+  EXPECT_FALSE(mixerPlanChannelInLoop(2));
+}
+
 TEST_F(MixerTest, BlockingChannel)
 {
   g_model.mixData[0].destCh = 0;
@@ -618,6 +701,35 @@ TEST_F(MixerTest, SlowDisabledOnStartup)
   EXPECT_EQ(chans[0], CHANNEL_MAX);
 }
 
+TEST_F(MixerTest, PlanFollowsModelEdits)
+{
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].mltpx = MLTPX_ADD;
+  g_model.mixData[0].srcRaw = MIXSRC_MAX;
+  g_model.mixData[0].weight = 100;
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX);
+
+  // edits are picked up once notified, as the menus do
+  g_model.mixData[0].weight = 50;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].mltpx = MLTPX_ADD;
+  g_model.mixData[1].srcRaw = MIXSRC_CH1;
+  g_model.mixData[1].weight = 100;
+  g_model.mixData[1].offset = -50;
+  storageDirty(EE_MODEL);
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX/2);
+  EXPECT_EQ(chans[1], 0);
+
+  memclear(&g_model.mixData[1], sizeof(MixData));
+  storageDirty(EE_MODEL);
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[1], 0);
+  EXPECT_EQ(mixerPlan.count, 1);
+
+}
+
 TEST_F(MixerTest, DelayOnSwitch)
 {
   g_model.mixData[0].destCh = 0;
@@ -829,6 +941,108 @@ TEST_F(MixerTest, flightModeOverflow)
   CHECK_FLIGHT_MODE_TRANSITION(0, 1000, 1024, 1024);
 }
 
+// Runs flight mode fades and records all the outputs at every step. The
+// reference run goes through the evaluation used when the mixer lines cannot
+// be ordered: every fading flight mode in full, channels in model order.
+static void runFlightModeFades(std::vector<int16_t> & outputs, bool reference)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  setModelDefaults();
+  g_model.flightModeData[1].swtch = TR(SWSRC_ID2, SWSRC_SA2);
+  for (uint8_t fm = 0; fm < 2; fm++) {
+    g_model.flightModeData[fm].fadeIn = 10;
+    g_model.flightModeData[fm].fadeOut = 10;
+  }
+  g_model.flightModeData[1].trim[RUD_STICK].mode = 2;
+  g_model.flightModeData[1].trim[RUD_STICK].value = -80;
+  g_model.flightModeData[1].trim[ELE_STICK].mode = 2;
+  g_model.flightModeData[1].trim[ELE_STICK].value = 100;
+  g_model.flightModeData[0].gvars[0] = 50;
+  g_model.flightModeData[1].gvars[0] = -30;
+
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].mltpx = MLTPX_REPL;
+  g_model.mixData[0].srcRaw = MIXSRC_MAX;
+  g_model.mixData[0].flightModes = 0b11110;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 0;
+  g_model.mixData[1].mltpx = MLTPX_REPL;
+  g_model.mixData[1].srcRaw = MIXSRC_MAX;
+  g_model.mixData[1].flightModes = 0b11101;
+  g_model.mixData[1].weight = -10;
+  g_model.mixData[2].destCh = 1;
+  g_model.mixData[2].srcRaw = MIXSRC_Ele;
+  g_model.mixData[2].weight = 100;
+  g_model.mixData[3].destCh = 2;
+  g_model.mixData[3].srcRaw = MIXSRC_FIRST_INPUT;
+  g_model.mixData[3].weight = 100;
+  g_model.mixData[4].destCh = 3;
+  g_model.mixData[4].srcRaw = MIXSRC_MAX;
+  g_model.mixData[4].weight = -1024; // GV1
+  g_model.mixData[5].destCh = 4;
+  g_model.mixData[5].srcRaw = MIXSRC_CH1;
+  g_model.mixData[5].weight = 50;
+  g_model.mixData[6].destCh = 5;
+  g_model.mixData[6].srcRaw = MIXSRC_Thr;
+  g_model.mixData[6].weight = 100;
+  g_model.mixData[7].destCh = 6;
+  g_model.mixData[7].srcRaw = MIXSRC_MAX;
+  g_model.mixData[7].flightModes = 0b11110;
+  g_model.mixData[7].weight = 100;
+  g_model.mixData[7].speedUp = 20;
+  g_model.mixData[7].speedDown = 20;
+
+  anaInValues[RUD_STICK] = -200;
+  anaInValues[ELE_STICK] = 300;
+  anaInValues[THR_STICK] = 500;
+
+  s_mixer_first_run_done = true;
+  simuSetSwitch(0, -1);
+  for (int i = 0; i < 10; i++) {
+    evalMixes(1);
+  }
+  if (reference) {
+    mixerPlan.ordered = false;
+  }
+
+  // fade to FM1, come back to FM0 before the end of the fade, then settle
+  simuSetSwitch(0, 1);
+  for (int i = 0; i < 300; i++) {
+    if (i == 60) simuSetSwitch(0, -1);
+    evalMixes(1);
+    outputs.insert(outputs.end(), channelOutputs, channelOutputs + MAX_OUTPUT_CHANNELS);
+  }
+}
+
+TEST_F(MixerTest, flightModeTransitionIncremental)
+{
+  std::vector<int16_t> incremental, full;
+
+  runFlightModeFades(incremental, false);
+  ASSERT_TRUE(mixerPlan.ordered);
+
+  runFlightModeFades(full, true);
+  ASSERT_FALSE(mixerPlan.ordered);
+  mixerPlanInvalidate();
+
+  // every channel, at every step of the fades
+  ASSERT_EQ(incremental.size(), full.size());
+  for (unsigned i = 0; i < full.size(); i++) {
+    EXPECT_EQ(incremental[i], full[i]) << "step " << i / MAX_OUTPUT_CHANNELS << " CH" << i % MAX_OUTPUT_CHANNELS + 1;
+  }
+
+  // the fades did change the outputs, and settled back to FM0
+  const int16_t settled[7] = { 1024, 300, -200, 512, 512, 500, 1024 };
+  const int16_t * last = &full[full.size() - MAX_OUTPUT_CHANNELS];
+  for (uint8_t ch = 0; ch < 7; ch++) {
+    EXPECT_EQ(last[ch], settled[ch]) << "CH" << ch + 1;
+  }
+  EXPECT_EQ(full[4 * MAX_OUTPUT_CHANNELS], 979);
+  EXPECT_EQ(full[59 * MAX_OUTPUT_CHANNELS], 360);
+}
+
 TEST_F(TrimsTest, throttleTrimWithCrossTrims)
 {
   g_model.thrTrim = 1;
@@ -977,3 +1191,165 @@ TEST_F(TrimsTest, invertedThrottlePlusThrottleTrimWithCrossTrims)
   EXPECT_EQ(channelOutputs[2], +1024);
   EXPECT_EQ(channelOutputs[1], 0);
 }
+
+TEST_F(MixerTest, LimitsPlan)
+{
+  // CH1..CH9 outputs, as computed by applyLimits() before the limits plan
+  static const int16_t expected[] = {
+    615, -1024, 204, 614, 512, -308, -794, -717, 615
+  };
+
+  g_model.points[0] = -100;
+  g_model.points[1] = -60;
+  g_model.points[2] = 20;
+  g_model.points[3] = 60;
+  g_model.points[4] = 100;
+
+  const int8_t weights[] = { 50, -100, 0, -50, 50, -50, 75, 100, 50 };
+  for (uint8_t ch = 0; ch < DIM(weights); ch++) {
+    g_model.mixData[ch].destCh = ch;
+    g_model.mixData[ch].srcRaw = MIXSRC_MAX;
+    g_model.mixData[ch].weight = weights[ch];
+  }
+
+  // offsets
+  limitAddress(0)->offset = 200;
+  limitAddress(1)->offset = -300;
+  // curves
+  limitAddress(2)->curve = 1;
+  limitAddress(3)->curve = -1;
+  // PPM center (only applied when the pulses are built)
+  limitAddress(4)->ppmCenter = 100;
+  // symmetrical
+  limitAddress(5)->offset = 300;
+  limitAddress(5)->min = -200;
+  limitAddress(5)->symetrical = 1;
+  // reversed
+  limitAddress(6)->offset = 100;
+  limitAddress(6)->revert = 1;
+  limitAddress(7)->max = -300;
+  limitAddress(7)->symetrical = 1;
+  limitAddress(7)->revert = 1;
+  // GVAR offset
+  g_model.flightModeData[0].gvars[0] = 20;
+  limitAddress(8)->offset = GV_CALC_VALUE_IDX_POS(0, GV1_LARGE);
+
+  evalMixes(1);
+  EXPECT_TRUE(limitsPlan.dynamic & (1 << 8));
+  for (uint8_t ch = 0; ch < DIM(expected); ch++) {
+    EXPECT_EQ(channelOutputs[ch], expected[ch]) << "CH" << ch + 1;
+  }
+
+  // edits are applied once notified
+  limitAddress(0)->revert = 1;
+  evalMixes(1);
+  EXPECT_EQ(channelOutputs[0], expected[0]);
+  storageDirty(EE_MODEL);
+  evalMixes(1);
+  EXPECT_EQ(channelOutputs[0], -expected[0]);
+}
+
+TEST_F(MixerTest, SourcesSnapshot)
+{
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].srcRaw = MIXSRC_Thr;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].srcRaw = MIXSRC_Thr;
+  g_model.mixData[1].weight = 50;
+  g_model.mixData[2].destCh = 2;
+  g_model.mixData[2].srcRaw = MIXSRC_LAST_TELEM + 1;  // out of range
+  g_model.mixData[2].weight = 100;
+
+  anaInValues[THR_STICK] = 512;
+  evalMixes(1);
+  EXPECT_EQ(chans[0], CHANNEL_MAX / 2);
+  EXPECT_EQ(chans[1], CHANNEL_MAX / 4);
+  EXPECT_EQ(chans[2], 0);
+
+  // a source not referenced so far is picked up when the lines change
+  g_model.mixData[1].srcRaw = MIXSRC_MAX;
+  storageDirty(EE_MODEL);
+  anaInValues[THR_STICK] = -1024;
+  evalMixes(1);
+  EXPECT_EQ(chans[0], -CHANNEL_MAX);
+  EXPECT_EQ(chans[1], CHANNEL_MAX / 2);
+  EXPECT_TRUE(mixerPlan.sources[MIXSRC_MAX / 32] & (1u << (MIXSRC_MAX % 32)));
+}
+
+TEST(MixerScheduler, modulesWithoutPeriod)
+{
+  MixerSchedule schedules[2] = {};
+  uint8_t due = 0;
+
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 4000, -1, due), 0);
+  EXPECT_EQ(due, 0b11);
+}
+
+TEST(MixerScheduler, twoPeriods)
+{
+  MixerSchedule schedules[2] = {};
+  schedules[0].period = 4000;
+  schedules[1].period = 7000;
+  uint8_t due = 0;
+
+  // first frames are due right away
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 0, -1, due), 4000);
+  EXPECT_EQ(due, 0b11);
+
+  due = 0;
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 4000, -1, due), 3000);
+  EXPECT_EQ(due, 0b01);
+
+  due = 0;
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 3000, -1, due), 1000);
+  EXPECT_EQ(due, 0b10);
+
+  due = 0;
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 1000, -1, due), 4000);
+  EXPECT_EQ(due, 0b01);
+  EXPECT_EQ(schedules[1].remaining, 6000);
+}
+
+TEST(MixerScheduler, closeFramesShareACycle)
+{
+  MixerSchedule schedules[2] = {};
+  schedules[0].period = 4000;
+  schedules[0].remaining = 4000;
+  schedules[1].period = 4000;
+  schedules[1].remaining = 4000 + MIXER_SCHEDULER_MERGE_US;
+  uint8_t due = 0;
+
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 4000, -1, due), 4000);
+  EXPECT_EQ(due, 0b11);
+  EXPECT_EQ(schedules[1].remaining, (int32_t)(4000 + MIXER_SCHEDULER_MERGE_US));
+
+  // just outside the merge delay: a cycle of its own
+  schedules[1].remaining = 4000 + MIXER_SCHEDULER_MERGE_US + 10;
+  due = 0;
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 4000, -1, due), MIXER_SCHEDULER_MERGE_US + 10);
+  EXPECT_EQ(due, 0b01);
+}
+
+TEST(MixerScheduler, syncAndLateFrames)
+{
+  MixerSchedule schedules[2] = {};
+  schedules[0].period = 4000;
+  schedules[0].remaining = 2500;
+  schedules[1].period = 9000;
+  schedules[1].remaining = 9000;
+  uint8_t due = 0;
+
+  // the heartbeat re-aligns the module schedule
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 500, 0, due), 4000);
+  EXPECT_EQ(due, 0b01);
+  EXPECT_EQ(schedules[0].remaining, 4000);
+  EXPECT_EQ(schedules[1].remaining, 8500);
+
+  // late by more than a period: next frame one period from now
+  due = 0;
+  EXPECT_EQ(mixerSchedulesAdvance(schedules, 2, 10000, -1, due), 4000);
+  EXPECT_EQ(due, 0b11);
+  EXPECT_EQ(schedules[0].remaining, 4000);
+  EXPECT_EQ(schedules[1].remaining, 7500);
+}
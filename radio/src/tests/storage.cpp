@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "gtests.h"
+#include "location.h"
+
+#if defined(SDCARD_YAML)
+#include "storage/sdcard_yaml.h"
+#include "storage/yaml/yaml_tree_walker.h"
+#include "storage/yaml/yaml_datastructs.h"
+
+TEST(Storage, yamlModelRoundTrip)
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+  sdCheckAndCreateDirectory(MODELS_PATH);
+
+  MODEL_RESET();
+  strcpy(g_model.header.name, "Yaml");
+  // enough mixes for the file to span several read blocks
+  for (int i = 0; i < MAX_MIXERS; i++) {
+    g_model.mixData[i].destCh = i / 8;
+    g_model.mixData[i].srcRaw = MIXSRC_FIRST_STICK + i % 4;
+    g_model.mixData[i].weight = i + 1;
+  }
+  EXPECT_EQ(nullptr, writeModelYaml("model99.yml"));
+
+  MODEL_RESET();
+  EXPECT_EQ(nullptr, readModelYaml("model99.yml", (uint8_t *)&g_model, sizeof(g_model)));
+  EXPECT_STRNEQ("Yaml", g_model.header.name);
+  for (int i = 0; i < MAX_MIXERS; i++) {
+    EXPECT_EQ(i / 8, g_model.mixData[i].destCh);
+    EXPECT_EQ(MIXSRC_FIRST_STICK + i % 4, g_model.mixData[i].srcRaw);
+    EXPECT_EQ(i + 1, g_model.mixData[i].weight);
+  }
+
+  f_unlink(MODELS_PATH "/model99.yml");
+  deleteModelCache("model99.yml");
+  MODEL_RESET();
+  simuFatfsSetPaths("", "");
+}
+
+static std::string readFileContent(const char* path)
+{
+  std::string content;
+  FIL file;
+  if (f_open(&file, path, FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+    char buf[256];
+    UINT count;
+    while (f_read(&file, buf, sizeof(buf), &count) == FR_OK && count > 0)
+      content.append(buf, count);
+    f_close(&file);
+  }
+  return content;
+}
+
+// the model file updated in place is the same as a new one
+static void checkModelUpdate(const char* filename)
+{
+  char path[256];
+  getModelPath(path, filename);
+  EXPECT_EQ(nullptr, writeModelYaml(filename));
+  EXPECT_EQ(nullptr, writeFileYaml(MODELS_PATH "/model95.yml", get_modeldata_nodes(), (uint8_t *)&g_model, 0));
+  std::string expected = readFileContent(MODELS_PATH "/model95.yml");
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, readFileContent(path));
+}
+
+TEST(Storage, yamlModelUpdate)
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+  sdCheckAndCreateDirectory(MODELS_PATH);
+  f_unlink(MODELS_PATH "/model96.yml");
+
+  MODEL_RESET();
+  strcpy(g_model.header.name, "Update");
+  for (int i = 0; i < 32; i++) {
+    g_model.mixData[i].destCh = i / 4;
+    g_model.mixData[i].srcRaw = MIXSRC_FIRST_STICK + i % 4;
+    g_model.mixData[i].weight = 50;
+  }
+  checkModelUpdate("model96.yml");
+
+  // same length
+  g_model.timers[0].value = 5;
+  g_model.mixData[3].weight = 60;
+  checkModelUpdate("model96.yml");
+  checkModelUpdate("model96.yml");
+
+  // longer
+  g_model.timers[0].value = 12345;
+  g_model.mixData[12].weight = -100;
+  checkModelUpdate("model96.yml");
+
+  // shorter
+  memclear(&g_model.mixData[8], sizeof(MixData) * 24);
+  strcpy(g_model.header.name, "U");
+  checkModelUpdate("model96.yml");
+
+  f_unlink(MODELS_PATH "/model95.yml");
+  f_unlink(MODELS_PATH "/model96.yml");
+  MODEL_RESET();
+  simuFatfsSetPaths("", "");
+}
+
+TEST(Storage, yamlModelKeysOrder)
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+  sdCheckAndCreateDirectory(MODELS_PATH);
+
+  // keys in another order than the one they are written in
+  FIL file;
+  ASSERT_EQ(FR_OK, f_open(&file, MODELS_PATH "/model97.yml", FA_CREATE_ALWAYS | FA_WRITE));
+  f_puts("limitData:\r\n"
+         "  5:\r\n"
+         "    max: 50\r\n"
+         "    min: -40\r\n"
+         "  2:\r\n"
+         "    offset: 10\r\n"
+         "mixData:\r\n"
+         "  - name: \"Last\"\r\n"
+         "    mltpx: REPL\r\n"
+         "    destCh: 3\r\n"
+         "    weight: 25\r\n"
+         "  - speedUp: 4\r\n"
+         "    mltpx: MUL\r\n"
+         "    weight: -10\r\n"
+         "trimInc: 2\r\n"
+         "extendedLimits: 1\r\n"
+         "header:\r\n"
+         "  name: \"Order\"\r\n"
+         "noGlobalFunctions: 1\r\n", &file);
+  f_close(&file);
+
+  MODEL_RESET();
+  EXPECT_EQ(nullptr, readModelYaml("model97.yml", (uint8_t *)&g_model, sizeof(g_model)));
+  EXPECT_STRNEQ("Order", g_model.header.name);
+  EXPECT_EQ(2, g_model.trimInc);
+  EXPECT_EQ(1, g_model.extendedLimits);
+  EXPECT_EQ(1, g_model.noGlobalFunctions);
+  EXPECT_STRNEQ("Last", g_model.mixData[0].name);
+  EXPECT_EQ(MLTPX_REPL, g_model.mixData[0].mltpx);
+  EXPECT_EQ(3, g_model.mixData[0].destCh);
+  EXPECT_EQ(25, g_model.mixData[0].weight);
+  EXPECT_EQ(4, g_model.mixData[1].speedUp);
+  EXPECT_EQ(MLTPX_MUL, g_model.mixData[1].mltpx);
+  EXPECT_EQ(-10, g_model.mixData[1].weight);
+  EXPECT_EQ(50, g_model.limitData[5].max);
+  EXPECT_EQ(-40, g_model.limitData[5].min);
+  EXPECT_EQ(10, g_model.limitData[2].offset);
+  EXPECT_EQ(0, g_model.limitData[3].offset);
+
+  f_unlink(MODELS_PATH "/model97.yml");
+  deleteModelCache("model97.yml");
+  MODEL_RESET();
+  simuFatfsSetPaths("", "");
+}
+
+TEST(Storage, modelCache)
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+  sdCheckAndCreateDirectory(MODELS_PATH);
+
+  MODEL_RESET();
+  strcpy(g_model.header.name, "Cache");
+  g_model.mixData[0].weight = 42;
+  EXPECT_EQ(nullptr, writeModelYaml("model98.yml"));
+
+  // reading the model alone (models list, labels) doesn't write the cache
+  FILINFO fno;
+  MODEL_RESET();
+  EXPECT_EQ(nullptr, readModelYaml("model98.yml", (uint8_t *)&g_model, sizeof(g_model)));
+  EXPECT_STRNEQ("Cache", g_model.header.name);
+  EXPECT_NE(FR_OK, f_stat(MODELS_PATH "/model98.cache", &fno));
+
+  // loading it does, the next reads use it
+  EXPECT_EQ(nullptr, loadModel(98, false));
+  EXPECT_EQ(FR_OK, f_stat(MODELS_PATH "/model98.cache", &fno));
+  for (auto cache: { ModelCache::Read, ModelCache::Update, ModelCache::None }) {
+    MODEL_RESET();
+    EXPECT_EQ(nullptr, readModelYaml("model98.yml", (uint8_t *)&g_model, sizeof(g_model), STR_MODELS_PATH, cache));
+    EXPECT_STRNEQ("Cache", g_model.header.name);
+    EXPECT_EQ(42, g_model.mixData[0].weight);
+    EXPECT_EQ(FR_OK, f_stat(MODELS_PATH "/model98.cache", &fno));
+  }
+
+  // a cache left by an older firmware or another model is not used
+  FIL file;
+  ASSERT_EQ(FR_OK, f_open(&file, MODELS_PATH "/model98.cache", FA_OPEN_EXISTING | FA_WRITE));
+  f_lseek(&file, 8);
+  f_puts("XXXX", &file);
+  f_close(&file);
+  MODEL_RESET();
+  EXPECT_EQ(nullptr, readModelYaml("model98.yml", (uint8_t *)&g_model, sizeof(g_model)));
+  EXPECT_STRNEQ("Cache", g_model.header.name);
+  EXPECT_EQ(42, g_model.mixData[0].weight);
+  EXPECT_EQ(nullptr, loadModel(98, false));
+
+  // a model file changed elsewhere is parsed again
+  ASSERT_EQ(FR_OK, f_open(&file, MODELS_PATH "/model98.yml", FA_OPEN_EXISTING | FA_WRITE | FA_OPEN_APPEND));
+  f_puts("header:\r\n  name: \"Edited\"\r\n", &file);
+  f_close(&file);
+  MODEL_RESET();
+  EXPECT_EQ(nullptr, readModelYaml("model98.yml", (uint8_t *)&g_model, sizeof(g_model)));
+  EXPECT_STRNEQ("Edited", g_model.header.name);
+  EXPECT_EQ(42, g_model.mixData[0].weight);
+
+  // saving the model drops the cache
+  EXPECT_EQ(nullptr, writeModelYaml("model98.yml"));
+  EXPECT_NE(FR_OK, f_stat(MODELS_PATH "/model98.cache", &fno));
+
+  f_unlink(MODELS_PATH "/model98.yml");
+  MODEL_RESET();
+  simuFatfsSetPaths("", "");
+}
+
+TEST(Storage, yamlRadioSettingsChecksum)
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+  sdCheckAndCreateDirectory(RADIO_PATH);
+
+  g_eeGeneral.vBatMin = -25;
+  EXPECT_EQ(nullptr, writeGeneralSettings());
+
+  YamlTreeWalker tree;
+  tree.reset(get_radiodata_nodes(), (uint8_t *)&g_eeGeneral);
+  g_eeGeneral.vBatMin = 0;
+  ChecksumResult checksum = ChecksumResult::None;
+  EXPECT_EQ(nullptr, readYamlFile(RADIO_SETTINGS_YAML_PATH, YamlTreeWalker::get_parser_calls(), &tree, &checksum));
+  EXPECT_EQ(ChecksumResult::Success, checksum);
+  EXPECT_EQ(-25, g_eeGeneral.vBatMin);
+
+  // a changed value is detected
+  FIL file;
+  ASSERT_EQ(FR_OK, f_open(&file, RADIO_SETTINGS_YAML_PATH, FA_OPEN_EXISTING | FA_WRITE | FA_OPEN_APPEND));
+  f_puts("vBatMin: -30\r\n", &file);
+  f_close(&file);
+  tree.reset(get_radiodata_nodes(), (uint8_t *)&g_eeGeneral);
+  EXPECT_EQ(nullptr, readYamlFile(RADIO_SETTINGS_YAML_PATH, YamlTreeWalker::get_parser_calls(), &tree, &checksum));
+  EXPECT_EQ(ChecksumResult::Failed, checksum);
+
+  f_unlink(RADIO_SETTINGS_YAML_PATH);
+  RADIO_RESET();
+  simuFatfsSetPaths("", "");
+}
+#endif
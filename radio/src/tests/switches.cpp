@@ -20,6 +20,7 @@
  */
 
 #include "gtests.h"
+#include "mixer_plan.h"
 
 void setLogicalSwitch(int index, uint16_t _func, int16_t _v1, int16_t _v2, int16_t _v3 = 0, uint8_t _delay = 0, uint8_t _duration = 0, int8_t _andsw = 0)
 {
@@ -30,6 +31,7 @@ void setLogicalSwitch(int index, uint16_t _func, int16_t _v1, int16_t _v2, int16
   g_model.logicalSw[index].delay = _delay;
   g_model.logicalSw[index].duration = _duration;
   g_model.logicalSw[index].andsw = _andsw;
+  storageDirty(EE_MODEL);
 }
 
 #if defined(PCBTARANIS)
@@ -310,3 +312,47 @@ TEST(getSwitch, edgeRelease)
 
 }
 #endif // defined(PCBTARANIS)
+
+#if defined(PCBTARANIS)
+TEST(evalLogicalSwitches, evaluationOrder)
+{
+  RADIO_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+
+  // L2 reads L1, which is evaluated first
+  setLogicalSwitch(0, LS_FUNC_AND, SWSRC_SA0, SWSRC_NONE);
+  setLogicalSwitch(1, LS_FUNC_AND, SWSRC_SW1, SWSRC_NONE);
+  // L3 only depends on L1 and L2
+  setLogicalSwitch(2, LS_FUNC_XOR, SWSRC_SW1, -SWSRC_SW2);
+  // L4 reads L5, which comes after it
+  setLogicalSwitch(3, LS_FUNC_AND, SWSRC_SW1+4, SWSRC_NONE);
+  setLogicalSwitch(4, LS_FUNC_AND, SWSRC_SA0, SWSRC_NONE);
+
+  simuSetSwitch(0, 0);
+  evalLogicalSwitches();
+  EXPECT_EQ(lswPlan.count, 5);
+  EXPECT_EQ(lswPlan.combinational, (uint64_t)0b00110);
+  EXPECT_EQ(getSwitch(SWSRC_SW1), false);
+  EXPECT_EQ(getSwitch(SWSRC_SW1+2), true);
+
+  bool previous = false;
+  for (int i = 0; i < 6; i++) {
+    bool sa0 = i & 1;
+    simuSetSwitch(0, sa0 ? -1 : 0);
+    evalLogicalSwitches();
+    EXPECT_EQ(getSwitch(SWSRC_SW1), sa0);
+    EXPECT_EQ(getSwitch(SWSRC_SW2), sa0);  // same cycle
+    EXPECT_EQ(getSwitch(SWSRC_SW1+2), true);
+    EXPECT_EQ(getSwitch(SWSRC_SW1+3), previous);  // previous cycle
+    EXPECT_EQ(getSwitch(SWSRC_SW1+4), sa0);
+    previous = sa0;
+  }
+
+  // a combinational switch is re-evaluated when edited
+  setLogicalSwitch(2, LS_FUNC_AND, SWSRC_SW1, SWSRC_SW2);
+  evalLogicalSwitches();
+  EXPECT_EQ(getSwitch(SWSRC_SW1+2), true);
+}
+#endif
+